@@ -378,6 +378,59 @@ namespace snarklib {
          : [modprime] "r" (inv_), [res] "r" (res_), [mod] "r" (mod_) \
          : "%rax", "%rdx", "cc", "memory")
 
+////////////////////////////////////////////////////////////////////////////////
+// Montgomery multiplication (CIOS) with MULX, ADCX and ADOX
+// Requires BMI2 and ADX. The accumulator limbs are registers named by
+// the macro arguments and rotate one place each outer iteration. Low
+// halves of products are added in the CF carry chain and high halves
+// in the OF carry chain. The modulus top bit must be clear so the
+// accumulator never needs more than N + 1 limbs.
+//
+
+/* rdx = B[i], clear CF and OF */
+#define MULX_LOADB(ofs)                                 \
+    "movq    " STR(ofs) "(%[B]), %%rdx     \n\t"        \
+    "xorl    %%eax, %%eax                  \n\t"
+
+/* t0:t1 = A[0] * rdx, first outer iteration only */
+#define MULX_FIRSTMUL(t0, t1)                           \
+    "mulxq   (%[A]), %%" t0 ", %%" t1 "    \n\t"
+
+/* tj:tj1 += A[ofs] * rdx with tj1 undefined, first outer iteration */
+#define MULX_FIRSTNEXT(ofs, tj, tj1)                    \
+    "mulxq   " STR(ofs) "(%[A]), %%rax, %%" tj1 " \n\t" \
+    "adcxq   %%rax, %%" tj "               \n\t"
+
+/* tj:tj1 += X[ofs] * rdx, X is A or M */
+#define MULX_ADDMUL(X, ofs, tj, tj1)                    \
+    "mulxq   " STR(ofs) "(%[" X "]), %%rax, %%rcx \n\t" \
+    "adcxq   %%rax, %%" tj "               \n\t"        \
+    "adoxq   %%rcx, %%" tj1 "              \n\t"
+
+/* remaining CF carry into the top limb, OF chain ends there */
+#define MULX_CARRY(tn)                                  \
+    "adcxq   %[zero], %%" tn "             \n\t"
+
+/* rdx = t0 * inv mod 2^64, clear CF and OF */
+#define MULX_REDUCE(t0)                                 \
+    "movq    %%" t0 ", %%rdx               \n\t"        \
+    "imulq   %[inv], %%rdx                 \n\t"        \
+    "xorl    %%eax, %%eax                  \n\t"
+
+/* A = t, then t - M */
+#define MULX_STORE(ofs, t)                              \
+    "movq    %%" t ", " STR(ofs) "(%[A])   \n\t"
+
+#define MULX_FIRSTSUB(t)                                \
+    "subq    (%[M]), %%" t "               \n\t"
+
+#define MULX_NEXTSUB(ofs, t)                            \
+    "sbbq    " STR(ofs) "(%[M]), %%" t "   \n\t"
+
+/* t < M if borrow, keep stored t */
+#define MULX_RESTORE(ofs, t)                            \
+    "cmovcq  " STR(ofs) "(%[A]), %%" t "   \n\t"
+
 } // namespace snarklib
 
 #endif
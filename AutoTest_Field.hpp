@@ -3,6 +3,7 @@
 
 #include <gmp.h>
 #include <string>
+#include <vector>
 
 #include /*libsnark*/ "algebra/fields/bigint.hpp"
 
@@ -452,6 +453,114 @@ private:
     const TFQE m_ell_0B, m_ell_VWB, m_ell_VVB;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// multiplication with MULX and ADX matches the older code
+// for arguments: (Fr), (Fq)
+//
+
+template <typename T>
+class AutoTest_FieldMulxADX : public AutoTest
+{
+public:
+    AutoTest_FieldMulxADX(const std::size_t count)
+        : AutoTest(count),
+          m_A{ T::zero(), T::one(), -T::one(), -(T::one() + T::one()) }
+    {
+        // edge cases near zero and the modulus, then random
+        for (std::size_t i = 0; i < count; ++i)
+            m_A.emplace_back(T::random());
+    }
+
+    void runTest() {
+        typedef typename T::BaseType F;
+
+        const bool saveMulx = F::mulxADX();
+
+        F::mulxADX(false);
+        const auto a = products();
+
+        F::mulxADX(true);
+        const auto b = products();
+
+        F::mulxADX(saveMulx);
+
+        checkPass(a == b);
+    }
+
+private:
+    // all pairs and all squares
+    std::vector<T> products() const {
+        std::vector<T> v;
+
+        for (const auto& x : m_A) {
+            for (const auto& y : m_A) {
+                v.emplace_back(x * y);
+            }
+
+            v.emplace_back(squared(x));
+
+            auto z = x;
+            z *= z;
+            v.emplace_back(z);
+        }
+
+        return v;
+    }
+
+    std::vector<T> m_A;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// array multiplication matches one at a time
+//
+
+template <typename T>
+class AutoTest_FieldMulArray : public AutoTest
+{
+public:
+    AutoTest_FieldMulArray(const std::size_t n,
+                           const std::size_t astride,
+                           const std::size_t bstride)
+        : AutoTest(n, astride, bstride),
+          m_n(n),
+          m_astride(astride),
+          m_bstride(bstride),
+          m_A(n * astride + 1),
+          m_B(n * bstride + 1)
+    {
+        for (auto& a : m_A) a = T::random();
+        for (auto& b : m_B) b = T::random();
+
+        // edge cases near the modulus
+        if (n) m_A[0] = m_B[0] = -T::one();
+    }
+
+    void runTest() {
+        typedef typename T::BaseType F;
+
+        auto A = m_A;
+        for (std::size_t i = 0; i < m_n; ++i)
+            A[i * m_astride] *= m_B[i * m_bstride];
+
+        const bool saveIFMA = F::arrayIFMA();
+
+        for (const bool ifma : { false, true }) {
+            F::arrayIFMA(ifma);
+
+            auto B = m_A;
+            mul_array(B.data(), m_B.data(), m_n, m_astride, m_bstride);
+
+            checkPass(A == B);
+        }
+
+        F::arrayIFMA(saveIFMA);
+    }
+
+private:
+    const std::size_t m_n, m_astride, m_bstride;
+    std::vector<T> m_A, m_B;
+};
+
 } // namespace snarklib
 
 #endif
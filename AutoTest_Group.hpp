@@ -3,6 +3,7 @@
 
 #include <gmp.h>
 #include <string>
+#include <vector>
 
 #include /*libsnark*/ "algebra/fields/bigint.hpp"
 
@@ -322,6 +323,82 @@ private:
     const T m_B;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// batch affine addition matches addition
+//
+
+template <typename T>
+class AutoTest_GroupBatchAddSpecial : public AutoTest
+{
+public:
+    AutoTest_GroupBatchAddSpecial(const std::size_t numberElems)
+        : AutoTest(numberElems),
+          m_numberElems(numberElems)
+    {}
+
+    void runTest() {
+        std::vector<T> a, b;
+        randomVector(a, m_numberElems);
+        randomVector(b, m_numberElems);
+
+        // exceptional cases: zero, doubling, inverse elements
+        a.emplace_back(T::zero());
+        b.emplace_back(T::random());
+        a.emplace_back(T::random());
+        b.emplace_back(T::zero());
+        a.emplace_back(T::random());
+        b.emplace_back(a.back());
+        a.emplace_back(T::random());
+        b.emplace_back(-a.back());
+
+        batchSpecial(a);
+        batchSpecial(b);
+
+        std::vector<T> c;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            c.emplace_back(a[i] + b[i]);
+        }
+
+        batchAddSpecial(a, b);
+
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            checkPass(c[i] == a[i] && a[i].isSpecial());
+        }
+    }
+
+private:
+    const std::size_t m_numberElems;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// GLV endomorphism multiplication matches double and add
+//
+
+template <typename T, typename F>
+class AutoTest_GroupGLV : public AutoTest
+{
+public:
+    AutoTest_GroupGLV()
+        : AutoTest(),
+          m_A(F::random()),
+          m_B(T::random())
+    {}
+
+    void runTest() {
+        const auto k = m_A[0].asBigInt();
+
+        checkPass(power(k, m_B) == m_A * m_B);
+        checkPass(power(k, m_B) == k * m_B);
+
+        // modulus of scalar field is not reduced
+        checkPass((m_B.scalarModulus() * m_B).isZero());
+    }
+
+private:
+    const F m_A;
+    const T m_B;
+};
+
 } // namespace snarklib
 
 #endif
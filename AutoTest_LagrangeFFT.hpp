@@ -2,6 +2,12 @@
 #define _SNARKLIB_AUTOTEST_LAGRANGE_FFT_HPP_
 
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unistd.h>
 #include <vector>
 
 #ifdef USE_OLD_LIBSNARK
@@ -12,6 +18,7 @@
 
 #include "snarklib/AutoTest.hpp"
 #include "snarklib/ForeignLib.hpp"
+#include "snarklib/HugeFFT.hpp"
 #include "snarklib/LagrangeFFTX.hpp"
 
 namespace snarklib {
@@ -404,6 +411,387 @@ private:
     std::vector<T> m_PB;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// six-step FFT and iFFT are same as radix-2
+//
+
+template <typename T>
+class AutoTest_LagrangeFFT_sixStep : public AutoTest
+{
+public:
+    AutoTest_LagrangeFFT_sixStep(const std::size_t min_size)
+        : AutoTest(min_size),
+          m_FFT(min_size)
+    {
+        m_A.reserve(m_FFT->min_size());
+        for (std::size_t i = 0; i < m_FFT->min_size(); ++i)
+            m_A.emplace_back(T::random());
+    }
+
+    void runTest() {
+        typedef typename LagrangeFFT<T>::Base BASE;
+        const auto saveSize = BASE::sixStepSize();
+
+        auto a = m_A, b = m_A;
+
+        BASE::sixStepSize(-1);
+        m_FFT->FFT(a);
+        BASE::sixStepSize(2);
+        m_FFT->FFT(b);
+        checkPass(a == b);
+
+        BASE::sixStepSize(-1);
+        m_FFT->iFFT(a);
+        BASE::sixStepSize(2);
+        m_FFT->iFFT(b);
+        checkPass(a == b && a == m_A);
+
+        BASE::sixStepSize(saveSize);
+    }
+
+private:
+    LagrangeFFT<T> m_FFT;
+    std::vector<T> m_A;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// cached coset powers fused into FFT same as separate multiplication
+//
+
+template <typename T>
+class AutoTest_LagrangeFFT_cosetPowers : public AutoTest
+{
+public:
+    AutoTest_LagrangeFFT_cosetPowers(const std::size_t min_size)
+        : AutoTest(min_size),
+          m_FFT(min_size)
+    {
+        m_A.reserve(m_FFT->min_size());
+        for (std::size_t i = 0; i < m_FFT->min_size(); ++i)
+            m_A.emplace_back(T::random());
+    }
+
+    void runTest() {
+        typedef typename LagrangeFFT<T>::Base BASE;
+        const auto saveSize = BASE::sixStepSize();
+
+        const auto g = T::params.multiplicative_generator();
+
+        for (const std::size_t sixStep : { std::size_t(-1), std::size_t(2) }) {
+            BASE::sixStepSize(sixStep);
+
+            for (const auto& h : { g, squared(g) }) {
+                auto a = m_A, b = m_A;
+
+                m_FFT->cosetFFT(a, h);
+                multiply(b, h);
+                m_FFT->FFT(b);
+                checkPass(a == b);
+
+                m_FFT->icosetFFT(a, h);
+                m_FFT->iFFT(b);
+                multiply(b, inverse(h));
+                checkPass(a == b && a == m_A);
+            }
+        }
+
+        BASE::sixStepSize(saveSize);
+    }
+
+private:
+    static void multiply(std::vector<T>& a, const T& g) {
+        T u = T::one();
+        for (auto& x : a) {
+            x *= u;
+            u *= g;
+        }
+    }
+
+    LagrangeFFT<T> m_FFT;
+    std::vector<T> m_A;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// batch FFT, iFFT and cosetFFT are same as one vector at a time
+//
+
+template <typename T>
+class AutoTest_LagrangeFFT_batchFFT : public AutoTest
+{
+public:
+    AutoTest_LagrangeFFT_batchFFT(const std::size_t min_size,
+                                  const std::size_t numVecs)
+        : AutoTest(min_size, numVecs),
+          m_FFT(min_size),
+          m_A(numVecs)
+    {
+        for (auto& a : m_A) {
+            a.reserve(m_FFT->min_size());
+            for (std::size_t i = 0; i < m_FFT->min_size(); ++i)
+                a.emplace_back(T::random());
+        }
+    }
+
+    void runTest() {
+        const auto g = T::params.multiplicative_generator();
+
+        auto A = m_A, B = m_A;
+        std::vector<std::vector<T>*> ptrB;
+        for (auto& b : B)
+            ptrB.push_back(&b);
+
+        for (auto& a : A) m_FFT->FFT(a);
+        m_FFT->batchFFT(ptrB);
+        checkPass(A == B);
+
+        for (auto& a : A) m_FFT->iFFT(a);
+        m_FFT->batchiFFT(ptrB);
+        checkPass(A == B && A == m_A);
+
+        for (auto& a : A) m_FFT->cosetFFT(a, g);
+        m_FFT->batchCosetFFT(ptrB, g);
+        checkPass(A == B);
+    }
+
+private:
+    LagrangeFFT<T> m_FFT;
+    std::vector<std::vector<T>> m_A;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// parallel batch inversion same as one at a time
+//
+
+template <typename T>
+class AutoTest_LagrangeFFT_batchInvert : public AutoTest
+{
+public:
+    AutoTest_LagrangeFFT_batchInvert(const std::size_t vecSize)
+        : AutoTest(vecSize),
+          m_A(vecSize)
+    {
+        for (auto& a : m_A) {
+            do {
+                a = T::random();
+            } while (a.isZero());
+        }
+    }
+
+    void runTest() {
+        auto B = m_A;
+        batch_invert_parallel(B);
+
+        for (std::size_t i = 0; i < m_A.size(); ++i)
+            checkPass(inverse(m_A[i]) == B[i]);
+    }
+
+private:
+    std::vector<T> m_A;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// domains of the same size are shared between threads
+//
+
+template <typename T>
+class AutoTest_LagrangeFFT_domainCache : public AutoTest
+{
+public:
+    AutoTest_LagrangeFFT_domainCache(const std::size_t min_size,
+                                     const std::size_t numThreads)
+        : AutoTest(min_size, numThreads),
+          m_min_size(min_size),
+          m_numThreads(numThreads)
+    {}
+
+    void runTest() {
+        const LagrangeFFT<T> A(m_min_size);
+        checkPass(std::addressof(*A) == std::addressof(*LagrangeFFT<T>(m_min_size)));
+
+        // first domain made after clearing is shared by all threads
+        LagrangeFFT<T>::clearCache();
+
+        const auto saveThreads = Parallel::numThreads();
+        Parallel::numThreads(m_numThreads);
+
+        std::vector<const typename LagrangeFFT<T>::Base*> domain(m_numThreads);
+        Parallel::mapLambda(
+            m_numThreads,
+            [&] (const std::size_t i) {
+                domain[i] = std::addressof(*LagrangeFFT<T>(m_min_size));
+            });
+
+        Parallel::numThreads(saveThreads);
+
+        const LagrangeFFT<T> B(m_min_size);
+        checkPass(std::addressof(*A) != std::addressof(*B));
+        for (const auto& p : domain)
+            checkPass(std::addressof(*B) == p);
+
+        // cleared domain is still usable
+        std::vector<T> a(A->min_size());
+        for (auto& x : a)
+            x = T::random();
+
+        auto b = a;
+        A->FFT(a);
+        B->FFT(b);
+        checkPass(a == b);
+
+        // least recently used domain is released first
+        const auto saveSize = LagrangeFFT<T>::cacheSize();
+        LagrangeFFT<T>::cacheSize(2);
+
+        LagrangeFFT<T>{m_min_size + 1};
+        LagrangeFFT<T>{m_min_size};
+        LagrangeFFT<T>{m_min_size + 2};
+
+        checkPass(LagrangeFFT<T>::isCached(m_min_size));
+        checkPass(! LagrangeFFT<T>::isCached(m_min_size + 1));
+        checkPass(LagrangeFFT<T>::isCached(m_min_size + 2));
+
+        LagrangeFFT<T>::cacheSize(saveSize);
+    }
+
+private:
+    const std::size_t m_min_size, m_numThreads;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// FFT, iFFT and cosetFFT with one thread same as with many, sizes
+// of several blocks split bit reversal and stages into tasks
+//
+
+template <typename T>
+class AutoTest_LagrangeFFT_multiThread : public AutoTest
+{
+public:
+    AutoTest_LagrangeFFT_multiThread(const std::size_t min_size,
+                                     const std::size_t numThreads)
+        : AutoTest(min_size, numThreads),
+          m_numThreads(numThreads),
+          m_FFT(min_size)
+    {
+        m_A.reserve(m_FFT->min_size());
+        for (std::size_t i = 0; i < m_FFT->min_size(); ++i)
+            m_A.emplace_back(T::random());
+    }
+
+    void runTest() {
+        typedef typename LagrangeFFT<T>::Base BASE;
+        const auto saveSize = BASE::sixStepSize();
+        const auto saveThreads = Parallel::numThreads();
+
+        for (const std::size_t sixStep : { std::size_t(-1), std::size_t(2) }) {
+            BASE::sixStepSize(sixStep);
+
+            Parallel::numThreads(1);
+            const auto a = transforms();
+
+            Parallel::numThreads(m_numThreads);
+            const auto b = transforms();
+
+            checkPass(a == b);
+        }
+
+        Parallel::numThreads(saveThreads);
+        BASE::sixStepSize(saveSize);
+    }
+
+private:
+    std::vector<std::vector<T>> transforms() const {
+        const auto g = T::params.multiplicative_generator();
+
+        std::vector<std::vector<T>> v(3, m_A);
+
+        m_FFT->FFT(v[0]);
+        m_FFT->iFFT(v[1]);
+        m_FFT->cosetFFT(v[2], g);
+
+        return v;
+    }
+
+    const std::size_t m_numThreads;
+    LagrangeFFT<T> m_FFT;
+    std::vector<T> m_A;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// FFT of vector in files same as in memory
+//
+
+template <typename T>
+class AutoTest_LagrangeFFT_hugeFFT : public AutoTest
+{
+public:
+    AutoTest_LagrangeFFT_hugeFFT(const std::size_t n,
+                                 const std::size_t numBlocks)
+        : AutoTest(n, numBlocks),
+          m_numBlocks(numBlocks),
+          m_FFT(n),
+          m_A(n)
+    {
+        for (auto& a : m_A)
+            a = T::random();
+    }
+
+    void runTest() {
+        char dirname[] = "/tmp/snarklib_HugeFFT_XXXXXX";
+        if (! checkPass(nullptr != mkdtemp(dirname))) return;
+
+        const std::string prefix = std::string(dirname) + "/A";
+        const auto g = T::params.multiplicative_generator();
+        const std::size_t n = m_A.size();
+
+        HugeFFT<T> H(prefix, n, m_numBlocks);
+        checkPass(write_blockvector_raw(prefix, H.space(), m_A));
+
+        auto A = m_A;
+
+        m_FFT->FFT(A);
+        checkPass(H.FFT() && A == readFiles(H));
+
+        m_FFT->iFFT(A);
+        checkPass(H.iFFT() && A == readFiles(H) && A == m_A);
+
+        m_FFT->cosetFFT(A, g);
+        checkPass(H.cosetFFT(g) && A == readFiles(H));
+
+        m_FFT->divide_by_Z_on_coset(A);
+        checkPass(H.divide_by_Z_on_coset() && A == readFiles(H));
+
+        m_FFT->icosetFFT(A, g);
+        checkPass(H.icosetFFT(g) && A == readFiles(H));
+
+        checkPass(!! H);
+
+        for (std::size_t block = 0; block < m_numBlocks; ++block) {
+            std::stringstream ss;
+            ss << prefix << block;
+            std::remove(ss.str().c_str());
+        }
+
+        rmdir(dirname);
+    }
+
+private:
+    std::vector<T> readFiles(const HugeFFT<T>& H) const {
+        std::vector<T> a(H.size());
+
+        for (std::size_t block = 0; block < m_numBlocks; ++block) {
+            BlockVector<T> v;
+            if (! H.readBlock(block, v)) return std::vector<T>();
+            v.emplace(a);
+        }
+
+        return a;
+    }
+
+    const std::size_t m_numBlocks;
+    LagrangeFFT<T> m_FFT;
+    std::vector<T> m_A;
+};
+
 } // namespace snarklib
 
 #endif
@@ -1,7 +1,10 @@
 #ifndef _SNARKLIB_AUTOTEST_MULTIEXP_HPP_
 #define _SNARKLIB_AUTOTEST_MULTIEXP_HPP_
 
+#include <cassert>
 #include <gmp.h>
+#include <memory>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -19,6 +22,7 @@
 #include "snarklib/BigInt.hpp"
 #include "snarklib/ForeignLib.hpp"
 #include "snarklib/MultiExp.hpp"
+#include "snarklib/Parallel.hpp"
 
 namespace snarklib {
 
@@ -39,6 +43,12 @@ public:
           m_baseB(BigInt<N>(base) * T::one())
     {}
 
+    // random scalar of numBits bits, full width is N limbs
+    AutoTest_MultiExp_wnafExp(const std::size_t numBits,
+                              const std::string& base)
+        : AutoTest_MultiExp_wnafExp{randomScalar(numBits), base}
+    {}
+
     void runTest() {
         const auto a = opt_window_wnaf_exp(
 #ifdef USE_OLD_LIBSNARK
@@ -54,6 +64,38 @@ public:
     }
 
 private:
+    AutoTest_MultiExp_wnafExp(const BigInt<N>& scalar,
+                              const std::string& base)
+        : AutoTest(scalar, base),
+          m_scalarA(libsnarkScalar(scalar)),
+          m_scalarB(scalar),
+          m_baseA(to_bigint<N>(base) * U::one()),
+          m_baseB(BigInt<N>(base) * T::one())
+    {}
+
+    static BigInt<N> randomScalar(const std::size_t numBits) {
+#ifdef USE_ASSERT
+        assert(0 < numBits && numBits <= N * GMP_NUMB_BITS);
+#endif
+
+        auto a = BigInt<N>::random();
+        for (std::size_t i = numBits; i < N * GMP_NUMB_BITS; ++i)
+            a.clearBit(i);
+
+        // most significant bit is set
+        a.data()[(numBits - 1) / GMP_NUMB_BITS] |= 1ul << ((numBits - 1) % GMP_NUMB_BITS);
+
+        return a;
+    }
+
+    static libsnark::bigint<N> libsnarkScalar(const BigInt<N>& a) {
+        libsnark::bigint<N> b;
+        for (std::size_t i = 0; i < N; ++i)
+            b.data[i] = a.data()[i];
+
+        return b;
+    }
+
     const libsnark::bigint<N> m_scalarA;
     const BigInt<N> m_scalarB;
     const U m_baseA;
@@ -170,6 +212,209 @@ private:
     std::vector<G> m_scalarA;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// bucket method and Bos-Coster multiple exponentiation agree
+//
+
+template <typename T, typename F>
+class AutoTest_MultiExp_bucketExp : public AutoTest
+{
+public:
+    AutoTest_MultiExp_bucketExp(const std::size_t numTerms,
+                                const bool special)
+        : AutoTest(numTerms, special),
+          m_numTerms(numTerms)
+    {
+        randomVector(m_base, numTerms);
+        randomVector(m_scalar, numTerms);
+
+        // batched affine addition if special
+        if (special) batchSpecial(m_base);
+    }
+
+    void runTest() {
+        const auto a = bosCosterExp(m_base, m_scalar);
+        const auto b = bucketExp(m_base, m_scalar);
+
+        checkPass(a == b);
+    }
+
+private:
+    const std::size_t m_numTerms;
+    std::vector<T> m_base;
+    std::vector<F> m_scalar;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// multithreaded multiple exponentiation is identical to one thread
+//
+
+template <typename T, typename F>
+class AutoTest_MultiExp_multiThread : public AutoTest
+{
+public:
+    AutoTest_MultiExp_multiThread(const std::size_t numTerms,
+                                  const std::size_t numThreads)
+        : AutoTest(numTerms, numThreads),
+          m_numTerms(numTerms),
+          m_numThreads(numThreads)
+    {
+        randomVector(m_base, numTerms);
+        randomVector(m_scalar, numTerms);
+    }
+
+    void runTest() {
+        const auto saveThreads = Parallel::numThreads();
+
+        Parallel::numThreads(1);
+        const auto a = multiExp(m_base, m_scalar);
+
+        Parallel::numThreads(m_numThreads);
+        const auto b = multiExp(m_base, m_scalar);
+
+        Parallel::numThreads(saveThreads);
+
+        checkPass(a.x() == b.x() &&
+                  a.y() == b.y() &&
+                  a.z() == b.z());
+    }
+
+private:
+    const std::size_t m_numTerms, m_numThreads;
+    std::vector<T> m_base;
+    std::vector<F> m_scalar;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// zero, one and short scalar classes agree with multiple exponentiation
+//
+
+template <typename T, typename F>
+class AutoTest_MultiExp_scalarClass : public AutoTest
+{
+public:
+    AutoTest_MultiExp_scalarClass(const std::size_t numTerms)
+        : AutoTest(numTerms),
+          m_numTerms(numTerms)
+    {
+        randomVector(m_base, numTerms);
+        batchSpecial(m_base);
+
+        std::random_device rd;
+        std::mt19937_64 generator(rd());
+        std::uniform_int_distribution<unsigned long> word;
+
+        // zero, one, 8 bits, 32 bits, 64 bits, full size
+        for (std::size_t i = 0; i < numTerms; ++i) {
+            switch (word(generator) % 6) {
+            case (0) : m_scalar.emplace_back(F::zero()); break;
+            case (1) : m_scalar.emplace_back(F::one()); break;
+            case (2) : m_scalar.emplace_back(F(word(generator) & 0xff)); break;
+            case (3) : m_scalar.emplace_back(F(word(generator) & 0xffffffff)); break;
+            case (4) : m_scalar.emplace_back(F(word(generator))); break;
+            default : m_scalar.emplace_back(F::random());
+            }
+        }
+    }
+
+    void runTest() {
+        const auto a = multiExp(m_base, m_scalar);
+        const auto b = multiExp01(m_base, 0, 0, m_scalar, 0, nullptr);
+
+        checkPass(a == b);
+    }
+
+private:
+    const std::size_t m_numTerms;
+    std::vector<T> m_base;
+    std::vector<F> m_scalar;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// precomputed fixed base table and bucket method agree
+//
+
+template <typename T, typename F>
+class AutoTest_MultiExp_fixedBaseExp : public AutoTest
+{
+public:
+    AutoTest_MultiExp_fixedBaseExp(const std::size_t numTerms,
+                                   const std::size_t depth,
+                                   const std::size_t numThreads = 1)
+        : AutoTest(numTerms, depth, numThreads),
+          m_numTerms(numTerms),
+          m_numThreads(numThreads)
+    {
+        randomVector(m_base, numTerms);
+        randomVector(m_scalar, numTerms);
+        batchSpecial(m_base);
+
+        m_table = MultiExpTable<T>(m_base, depth, F::sizeInBits());
+    }
+
+    void runTest() {
+        const auto saveThreads = Parallel::numThreads();
+
+        Parallel::numThreads(1);
+        const auto a = bucketExp(m_base, m_scalar);
+
+        Parallel::numThreads(m_numThreads);
+        const auto b = multiExp(m_base, m_scalar, m_table);
+
+        Parallel::numThreads(saveThreads);
+
+        // both are special
+        checkPass(a.x() == b.x() &&
+                  a.y() == b.y() &&
+                  a.z() == b.z());
+    }
+
+private:
+    const std::size_t m_numTerms, m_numThreads;
+    std::vector<T> m_base;
+    std::vector<F> m_scalar;
+    MultiExpTable<T> m_table;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// batch multi-exponentiation and one scalar vector at a time agree
+//
+
+template <typename T, typename F>
+class AutoTest_MultiExp_batchExp : public AutoTest
+{
+public:
+    AutoTest_MultiExp_batchExp(const std::size_t numTerms,
+                               const std::size_t numSets)
+        : AutoTest(numTerms, numSets),
+          m_numTerms(numTerms),
+          m_scalar(numSets)
+    {
+        randomVector(m_base, numTerms);
+        batchSpecial(m_base);
+
+        for (auto& a : m_scalar) {
+            randomVector(a, numTerms);
+            m_scalarVec.push_back(std::addressof(a));
+        }
+    }
+
+    void runTest() {
+        const auto a = batchMultiExp(m_base, m_scalarVec);
+
+        if (checkPass(a.size() == m_scalar.size())) {
+            for (std::size_t i = 0; i < a.size(); ++i)
+                checkPass(a[i] == multiExp(m_base, m_scalar[i]));
+        }
+    }
+
+private:
+    const std::size_t m_numTerms;
+    std::vector<T> m_base;
+    std::vector<std::vector<F>> m_scalar;
+    std::vector<const std::vector<F>*> m_scalarVec;
+};
+
 } // namespace snarklib
 
 #endif
@@ -2,18 +2,21 @@
 #define _SNARKLIB_AUTOTEST_PPZK_HPP_
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "snarklib/AutoTest.hpp"
 #include "snarklib/AutoTest_R1CS.hpp"
 #include "snarklib/AuxSTL.hpp"
 #include "snarklib/ForeignLib.hpp"
+#include "snarklib/LagrangeFFT.hpp"
 #include "snarklib/Pairing.hpp"
 #include "snarklib/PPZK_keypair.hpp"
 #include "snarklib/PPZK_keystruct.hpp"
 #include "snarklib/PPZK_query.hpp"
 #include "snarklib/PPZK_proof.hpp"
 #include "snarklib/PPZK_verify.hpp"
+#include "snarklib/QAP_system.hpp"
 
 namespace snarklib {
 
@@ -430,6 +433,189 @@ private:
     const AutoTestR1CS<SYS, Fr, U> m_constraintSystem;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// batch of proofs same as one at a time
+//
+
+template <typename PAIRING>
+class AutoTest_PPZK_BatchProof : public AutoTest
+{
+    typedef typename PAIRING::Fr Fr;
+
+public:
+    AutoTest_PPZK_BatchProof(const std::size_t numConstraints,
+                             const std::size_t numSets,
+                             const std::size_t chunkSize)
+        : AutoTest(numConstraints, numSets, chunkSize),
+          m_chunkSize(chunkSize),
+          m_constraintSystem(productChainSystem<Fr>(numConstraints))
+    {
+        // chains of zero, one and random values
+        for (std::size_t s = 0; s < numSets; ++s) {
+            Fr x1 = Fr::random(), x2 = Fr::random();
+            switch (s % 4) {
+            case (0) : x1 = Fr::zero(); break;
+            case (1) : x1 = x2 = Fr::one(); break;
+            case (2) : x1 = Fr::one(); break;
+            }
+
+            m_witness.emplace_back(productChainWitness(numConstraints, x1, x2));
+            m_proofRand.emplace_back(0);
+        }
+    }
+
+    void runTest() {
+        const std::size_t numCircuitInputs = 2;
+
+        const PPZK_Keypair<PAIRING> keypair(m_constraintSystem,
+                                            numCircuitInputs,
+                                            PPZK_LagrangePoint<Fr>(0),
+                                            PPZK_BlindGreeks<Fr, Fr>(0));
+
+        const PPZK_BatchProof<PAIRING> batch(m_constraintSystem,
+                                             numCircuitInputs,
+                                             keypair.pk(),
+                                             m_witness,
+                                             m_proofRand,
+                                             m_chunkSize,
+                                             nullptr);
+
+        if (! checkPass(m_witness.size() == batch.size())) return;
+
+        for (std::size_t s = 0; s < batch.size(); ++s) {
+            const PPZK_Proof<PAIRING> proof(m_constraintSystem,
+                                            numCircuitInputs,
+                                            keypair.pk(),
+                                            m_witness[s],
+                                            m_proofRand[s]);
+
+            checkPass(proof == batch[s]);
+
+            checkPass(strongVerify(keypair.vk(),
+                                   m_witness[s].truncate(numCircuitInputs),
+                                   batch[s]));
+        }
+    }
+
+private:
+    const std::size_t m_chunkSize;
+    const R1System<Fr> m_constraintSystem;
+    std::vector<R1Witness<Fr>> m_witness;
+    std::vector<PPZK_ProofRandomness<Fr>> m_proofRand;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// proof with precomputed proving key same as with proving key
+//
+
+template <typename PAIRING>
+class AutoTest_PPZK_PrecomputedKey : public AutoTest
+{
+    typedef typename PAIRING::Fr Fr;
+
+public:
+    AutoTest_PPZK_PrecomputedKey(const std::size_t numConstraints,
+                                 const std::size_t depth)
+        : AutoTest(numConstraints, depth),
+          m_depth(depth),
+          m_constraintSystem(productChainSystem<Fr>(numConstraints)),
+          m_witness(productChainWitness(numConstraints, Fr::one(), Fr::random()))
+    {}
+
+    void runTest() {
+        const std::size_t numCircuitInputs = 2;
+
+        const PPZK_Keypair<PAIRING> keypair(m_constraintSystem,
+                                            numCircuitInputs,
+                                            PPZK_LagrangePoint<Fr>(0),
+                                            PPZK_BlindGreeks<Fr, Fr>(0));
+
+        const PPZK_PrecomputedKey<PAIRING> ppk(keypair.pk(), m_depth);
+
+        const PPZK_ProofRandomness<Fr> proofRand(0);
+
+        const PPZK_Proof<PAIRING>
+            proofA(m_constraintSystem,
+                   numCircuitInputs,
+                   keypair.pk(),
+                   m_witness,
+                   proofRand),
+            proofB(m_constraintSystem,
+                   numCircuitInputs,
+                   ppk,
+                   m_witness,
+                   proofRand);
+
+        checkPass(proofA == proofB);
+
+        checkPass(strongVerify(keypair.vk(),
+                               m_witness.truncate(numCircuitInputs),
+                               proofB));
+    }
+
+private:
+    const std::size_t m_depth;
+    const R1System<Fr> m_constraintSystem;
+    const R1Witness<Fr> m_witness;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// proofs on the same circuit share one evaluation domain
+//
+
+template <typename PAIRING>
+class AutoTest_PPZK_DomainCache : public AutoTest
+{
+    typedef typename PAIRING::Fr Fr;
+
+public:
+    AutoTest_PPZK_DomainCache(const std::size_t numConstraints)
+        : AutoTest(numConstraints),
+          m_constraintSystem(productChainSystem<Fr>(numConstraints)),
+          m_witness(productChainWitness(numConstraints, Fr::one(), Fr::random()))
+    {}
+
+    void runTest() {
+        const std::size_t numCircuitInputs = 2;
+
+        const PPZK_Keypair<PAIRING> keypair(m_constraintSystem,
+                                            numCircuitInputs,
+                                            PPZK_LagrangePoint<Fr>(0),
+                                            PPZK_BlindGreeks<Fr, Fr>(0));
+
+        const std::size_t degree = QAP_SystemPoint<R1System, Fr>(m_constraintSystem,
+                                                                 numCircuitInputs).degree();
+
+        LagrangeFFT<Fr>::clearCache();
+
+        const PPZK_Proof<PAIRING> proofA(m_constraintSystem,
+                                         numCircuitInputs,
+                                         keypair.pk(),
+                                         m_witness,
+                                         PPZK_ProofRandomness<Fr>(0));
+
+        // no LagrangeFFT is left after the proof
+        checkPass(LagrangeFFT<Fr>::isCached(degree));
+        const auto domain = std::addressof(*LagrangeFFT<Fr>(degree));
+
+        const PPZK_Proof<PAIRING> proofB(m_constraintSystem,
+                                         numCircuitInputs,
+                                         keypair.pk(),
+                                         m_witness,
+                                         PPZK_ProofRandomness<Fr>(0));
+
+        checkPass(domain == std::addressof(*LagrangeFFT<Fr>(degree)));
+
+        checkPass(strongVerify(keypair.vk(),
+                               m_witness.truncate(numCircuitInputs),
+                               proofB));
+    }
+
+private:
+    const R1System<Fr> m_constraintSystem;
+    const R1Witness<Fr> m_witness;
+};
+
 } // namespace snarklib
 
 #endif
@@ -1,7 +1,14 @@
 #ifndef _SNARKLIB_AUTOTEST_QAP_HPP_
 #define _SNARKLIB_AUTOTEST_QAP_HPP_
 
+#include <array>
 #include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
 
 #ifdef USE_OLD_LIBSNARK
 #include /*libsnark*/ "qap/qap.hpp"
@@ -14,6 +21,8 @@
 #include "snarklib/AutoTest.hpp"
 #include "snarklib/AutoTest_R1CS.hpp"
 #include "snarklib/ForeignLib.hpp"
+#include "snarklib/HugeFFT.hpp"
+#include "snarklib/IndexSpace.hpp"
 #include "snarklib/QAP_query.hpp"
 #include "snarklib/QAP_witness.hpp"
 #include "snarklib/Rank1DSL.hpp"
@@ -217,6 +226,123 @@ private:
     const T m_d1B, m_d2B, m_d3B;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// QAP witness with A, B, C on disk same as in memory
+//
+
+template <template <typename> class SYS, typename T, typename U>
+class AutoTest_QAP_HugeWitness : public AutoTest
+{
+public:
+    AutoTest_QAP_HugeWitness(const AutoTestR1CS<SYS, T, U>& cs,
+                             const std::size_t numBlocks,
+                             const std::size_t numHBlocks)
+        : AutoTest(cs, numBlocks, numHBlocks),
+          m_constraintSystem(cs.systemB()),
+          m_witness(cs.witnessB()),
+          m_numCircuitInputs(cs.numCircuitInputs()),
+          m_numBlocks(numBlocks),
+          m_numHBlocks(numHBlocks),
+          m_d1(T::random()),
+          m_d2(T::random()),
+          m_d3(T::random())
+    {}
+
+    // product chain system
+    AutoTest_QAP_HugeWitness(const std::size_t numConstraints,
+                             const std::size_t numCircuitInputs,
+                             const std::size_t numBlocks,
+                             const std::size_t numHBlocks)
+        : AutoTest(numConstraints, numCircuitInputs, numBlocks, numHBlocks),
+          m_constraintSystem(productChainSystem<T>(numConstraints)),
+          m_witness(productChainWitness(numConstraints, T::random(), T::random())),
+          m_numCircuitInputs(numCircuitInputs),
+          m_numBlocks(numBlocks),
+          m_numHBlocks(numHBlocks),
+          m_d1(T::random()),
+          m_d2(T::random()),
+          m_d3(T::random())
+    {}
+
+    void runTest() {
+        const QAP_SystemPoint<SYS, T> qap(m_constraintSystem,
+                                          m_numCircuitInputs);
+
+        const QAP_WitnessABCH<SYS, T> ABCH(qap,
+                                           m_witness,
+                                           m_d1,
+                                           m_d2,
+                                           m_d3);
+
+        char dirname[] = "/tmp/snarklib_HugeWitness_XXXXXX";
+        if (! checkPass(nullptr != mkdtemp(dirname))) return;
+
+        const std::string prefix = std::string(dirname) + "/W";
+
+        IndexSpace<1> hSpace(qap.degree() + 1);
+        hSpace.blockPartition(std::array<std::size_t, 1>{ m_numHBlocks });
+
+        const QAP_HugeWitnessABCH<SYS, T> hugeABCH(m_constraintSystem,
+                                                   m_numCircuitInputs,
+                                                   m_witness,
+                                                   m_d1,
+                                                   m_d2,
+                                                   m_d3,
+                                                   prefix,
+                                                   m_numBlocks,
+                                                   hSpace);
+
+        checkPass(qap.degree() == hugeABCH.degree());
+
+        if (HugeFFT<T>::supported(qap.degree(), m_numBlocks)) {
+            checkPass(!! hugeABCH && ABCH.vec() == readFiles(prefix + "H"));
+
+        } else {
+            // step domain is an error
+            checkPass(! hugeABCH);
+        }
+
+        for (std::size_t block = 0; block < m_numHBlocks; ++block) {
+            std::stringstream ss;
+            ss << prefix << "H" << block;
+            std::remove(ss.str().c_str());
+        }
+
+        // scratch files are gone, even after an error
+        checkPass(0 == rmdir(dirname));
+    }
+
+private:
+    std::vector<T> readFiles(const std::string& filePrefix) const {
+        std::vector<T> a;
+
+        for (std::size_t block = 0; block < m_numHBlocks; ++block) {
+            std::stringstream ss;
+            ss << filePrefix << block;
+
+            std::ifstream ifs(ss.str(), std::ios::binary);
+            BlockVector<T> v;
+            if (!ifs ||
+                ! v.marshal_in(
+                    ifs,
+                    [] (std::istream& i, T& x) { return x.marshal_in_raw(i); }))
+            {
+                return std::vector<T>();
+            }
+
+            if (a.empty()) a.resize(v.space().globalID()[0]);
+            v.emplace(a);
+        }
+
+        return a;
+    }
+
+    SYS<T> m_constraintSystem;
+    R1Witness<T> m_witness;
+    const std::size_t m_numCircuitInputs, m_numBlocks, m_numHBlocks;
+    const T m_d1, m_d2, m_d3;
+};
+
 } // namespace snarklib
 
 #endif
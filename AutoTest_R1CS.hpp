@@ -351,6 +351,40 @@ private:
     const unsigned long m_d1, m_d2, m_d3, m_d4, m_d5, m_d6;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// chain of products x[k] = x[k - 2] * x[k - 1] for k = 3, 4,... with
+// free variables x[1] and x[2], any values of them satisfy the system
+//
+
+template <typename T>
+R1System<T> productChainSystem(const std::size_t numConstraints)
+{
+    R1System<T> cs;
+
+    for (std::size_t k = 3; k < numConstraints + 3; ++k) {
+        const R1Variable<T> x(k - 2), y(k - 1), z(k);
+        cs.addConstraint(x * y == z);
+    }
+
+    return cs;
+}
+
+template <typename T>
+R1Witness<T> productChainWitness(const std::size_t numConstraints,
+                                 const T& x1,
+                                 const T& x2)
+{
+    R1Witness<T> witness;
+    witness.assignVar(R1Variable<T>(1), x1);
+    witness.assignVar(R1Variable<T>(2), x2);
+
+    for (std::size_t k = 3; k < numConstraints + 3; ++k) {
+        witness.assignVar(R1Variable<T>(k), witness[k - 3] * witness[k - 2]);
+    }
+
+    return witness;
+}
+
 } // namespace snarklib
 
 #endif
@@ -2,6 +2,13 @@
 #define _SNARKLIB_AUTOTEST_WINDOW_EXP_HPP_
 
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unistd.h>
 #include <vector>
 
 #ifdef USE_OLD_LIBSNARK
@@ -13,6 +20,8 @@
 #include "snarklib/AutoTest.hpp"
 #include "snarklib/AuxSTL.hpp"
 #include "snarklib/ForeignLib.hpp"
+#include "snarklib/Parallel.hpp"
+#include "snarklib/ProgressCallback.hpp"
 #include "snarklib/WindowExp.hpp"
 
 namespace snarklib {
@@ -347,6 +356,226 @@ private:
     const std::size_t m_exp_count, m_numWindowBlocks;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// window table is the same for any number of threads
+//
+
+template <typename G, typename F>
+class AutoTest_WindowExp_multiThread : public AutoTest
+{
+public:
+    AutoTest_WindowExp_multiThread(const std::size_t exp_count,
+                                   const std::size_t numThreads)
+        : AutoTest(exp_count, numThreads),
+          m_exp_count(exp_count),
+          m_numThreads(numThreads)
+    {}
+
+    void runTest() {
+        const auto saveThreads = Parallel::numThreads();
+
+        Parallel::numThreads(1);
+        const WindowExp<G> gTableA(m_exp_count);
+
+        Parallel::numThreads(m_numThreads);
+        const WindowExp<G> gTableB(m_exp_count);
+
+        Parallel::numThreads(saveThreads);
+
+        for (std::size_t i = 0; i < 10; ++i) {
+            const auto x = F::random();
+            const auto a = gTableA.exp(x), b = gTableB.exp(x);
+
+            checkPass(a.x() == b.x() &&
+                      a.y() == b.y() &&
+                      a.z() == b.z());
+        }
+    }
+
+private:
+    const std::size_t m_exp_count, m_numThreads;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// multithreaded batch exponentiation is same as single thread
+//
+
+template <typename G, typename F>
+class AutoTest_WindowExp_batchExpThreads : public AutoTest
+{
+public:
+    AutoTest_WindowExp_batchExpThreads(const std::size_t vecSize,
+                                       const std::size_t numThreads)
+        : AutoTest(vecSize, numThreads),
+          m_numThreads(numThreads)
+    {
+        m_vec.reserve(vecSize);
+        for (std::size_t i = 0; i < vecSize; ++i)
+            m_vec.emplace_back(i % 7 ? F::random() : F::zero());
+    }
+
+    void runTest() {
+        const WindowExp<G> A(m_vec.size());
+        const auto saveThreads = Parallel::numThreads();
+
+        Parallel::numThreads(1);
+        const auto result_A = A.batchExp(m_vec);
+        auto accum_A = result_A;
+        A.batchExp(accum_A, m_vec);
+
+        Parallel::numThreads(m_numThreads);
+        CountMinor countB, countC;
+        const auto result_B = A.batchExp(m_vec, std::addressof(countB));
+        auto accum_B = result_B;
+        A.batchExp(accum_B, m_vec, std::addressof(countC));
+
+        const BlockVector<F> partvec(BlockVector<F>::space(m_vec), 0, m_vec);
+        std::vector<G> result_C(m_vec.size());
+        A.batchExp(partvec).emplace(result_C);
+
+        Parallel::numThreads(saveThreads);
+
+        checkPass(result_A == result_B);
+        checkPass(accum_A == accum_B);
+        checkPass(result_A == result_C);
+        checkPass(countB.steps() == countB.minorSteps());
+        checkPass(countC.steps() == countC.minorSteps());
+    }
+
+private:
+    // counts minor steps
+    class CountMinor : public ProgressCallback_NOP<G>
+    {
+    public:
+        CountMinor() : m_steps(0) {}
+
+        std::size_t minorSteps() { return 3; }
+        void minor() { ++m_steps; }
+
+        std::size_t steps() const { return m_steps; }
+
+    private:
+        std::size_t m_steps;
+    };
+
+    const std::size_t m_numThreads;
+    std::vector<F> m_vec;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// table chosen for memory budget (comb or window) is same as original
+//
+
+template <typename G, typename F>
+class AutoTest_WindowExp_comb : public AutoTest
+{
+public:
+    AutoTest_WindowExp_comb(const std::size_t exp_count,
+                            const std::size_t maxTableBytes)
+        : AutoTest(exp_count, maxTableBytes),
+          m_exp_count(exp_count),
+          m_maxTableBytes(maxTableBytes)
+    {
+        m_vec.reserve(10);
+        m_vec.emplace_back(F::zero());
+        m_vec.emplace_back(F::one());
+        m_vec.emplace_back(-F::one());
+        for (std::size_t i = 0; i < 7; ++i)
+            m_vec.emplace_back(F::random());
+    }
+
+    void runTest() {
+        const WindowExp<G> gTableA(m_exp_count);
+        const WindowExp<G> gTableB(m_exp_count, m_maxTableBytes);
+
+        checkPass(gTableA.batchExp(m_vec) == gTableB.batchExp(m_vec));
+
+        for (const auto& x : m_vec)
+            checkPass(x * G::one() == gTableB.exp(x));
+    }
+
+private:
+    const std::size_t m_exp_count, m_maxTableBytes;
+    std::vector<F> m_vec;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// window table cached in file is same as original, stale file is rejected
+//
+
+template <typename G, typename F>
+class AutoTest_WindowExp_cacheFile : public AutoTest
+{
+public:
+    AutoTest_WindowExp_cacheFile(const std::size_t exp_count)
+        : AutoTest(exp_count),
+          m_exp_count(exp_count)
+    {}
+
+    void runTest() {
+        char dirname[] = "/tmp/snarklib_WindowExp_XXXXXX";
+        if (! checkPass(nullptr != mkdtemp(dirname))) return;
+
+        const WindowExp<G> gTable(m_exp_count);
+
+        // first time makes the file, second time maps it
+        const WindowExp<G> gTableA(m_exp_count, dirname);
+        checkPass(! gTableA.mapped());
+        const WindowExp<G> gTableB(m_exp_count, dirname);
+        checkPass(gTableB.mapped());
+
+        const auto files = listDir(dirname);
+        checkPass(1 == files.size());
+
+        // flip a bit in the last table element
+        for (const auto& name : files) {
+            std::fstream fs(name, std::ios::in | std::ios::out | std::ios::binary);
+            fs.seekg(-1, std::ios::end);
+            const char c = fs.get() ^ 1;
+            fs.seekp(-1, std::ios::end);
+            fs.put(c);
+        }
+
+        const WindowExp<G> gTableC(m_exp_count, dirname);
+        checkPass(! gTableC.mapped());
+
+        for (std::size_t i = 0; i < 10; ++i) {
+            const auto x = F::random();
+            const auto a = gTable.exp(x);
+
+            for (const auto& b : { gTableA.exp(x), gTableB.exp(x), gTableC.exp(x) }) {
+                checkPass(a.x() == b.x() &&
+                          a.y() == b.y() &&
+                          a.z() == b.z());
+            }
+        }
+
+        for (const auto& name : listDir(dirname))
+            std::remove(name.c_str());
+
+        rmdir(dirname);
+    }
+
+private:
+    static std::vector<std::string> listDir(const std::string& dirname) {
+        std::vector<std::string> v;
+
+        if (DIR* d = opendir(dirname.c_str())) {
+            while (const dirent* e = readdir(d)) {
+                const std::string name = e->d_name;
+                if ("." != name && ".." != name)
+                    v.emplace_back(dirname + "/" + name);
+            }
+
+            closedir(d);
+        }
+
+        return v;
+    }
+
+    const std::size_t m_exp_count;
+};
+
 } // namespace snarklib
 
 #endif
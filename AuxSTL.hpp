@@ -3,8 +3,10 @@
 
 #include <array>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <iostream>
+#include <new>
 #include <istream>
 #include <ostream>
 #include <queue>
@@ -446,6 +448,45 @@ private:
     std::vector<T> m_value;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// Allocator for memory aligned to cache lines
+// Used for lookup tables read at random so an element spans as few
+// cache lines as possible.
+//
+
+template <typename T, std::size_t ALIGN = 64>
+class AlignedAllocator
+{
+public:
+    typedef T value_type;
+
+    template <typename U> struct rebind { typedef AlignedAllocator<U, ALIGN> other; };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, ALIGN>&) {}
+
+    T* allocate(const std::size_t n) {
+        void* p = nullptr;
+
+        if (posix_memalign(&p, ALIGN, n * sizeof(T)))
+            throw std::bad_alloc();
+
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, const std::size_t) {
+        std::free(p);
+    }
+
+    template <typename U>
+    bool operator== (const AlignedAllocator<U, ALIGN>&) const { return true; }
+
+    template <typename U>
+    bool operator!= (const AlignedAllocator<U, ALIGN>&) const { return false; }
+};
+
 // std::vector iteration indices
 template <typename T> std::size_t vector_start(const std::vector<T>& a) { return 0; }
 template <typename T> std::size_t vector_stop(const std::vector<T>& a) { return a.size(); }
@@ -1,6 +1,7 @@
 #ifndef _SNARKLIB_EC_BN128_GROUP_CURVE_HPP_
 #define _SNARKLIB_EC_BN128_GROUP_CURVE_HPP_
 
+#include <gmp.h>
 #include <ostream>
 #include <tuple>
 #include <vector>
@@ -346,6 +347,111 @@ public:
 
         return vec;
     }
+
+    // a[i] = a[i] + b[i] with affine addition, all elements are special
+    template <typename GROUP>
+    static
+    std::vector<GROUP>& batchAddSpecial(std::vector<GROUP>& a,
+                                        const std::vector<GROUP>& b) {
+        return weierstrassBatchAddSpecial(a, b);
+    }
+
+    //
+    // GLV endomorphism (x, y) -> (beta * x, y) is multiplication by lambda
+    //
+
+    static constexpr bool hasEndomorphism() { return true; }
+
+    template <typename GROUP>
+    static
+    GROUP endomorphism(const GROUP& a) {
+        // Jacobian X is scaled like affine x
+        return GROUP(endo_beta(a.x()) * a.x(), a.y(), a.z());
+    }
+
+    // k = k1 + k2 * lambda (mod r) with k1 and k2 about half as many
+    // bits, returns false if k is not reduced modulo r
+    template <mp_size_t M>
+    static
+    bool glvDecompose(const BigInt<M>& k,
+                      BigInt<M>& k1, bool& neg1,
+                      BigInt<M>& k2, bool& neg2) {
+        // short lattice basis (a1, -b1) and (a2, b2), rounding constants
+        // g1 = b2 * 2^256 / r and g2 = b1 * 2^256 / r
+        static const BigInt<N>
+            a1("9931322734385697763"),
+            b1("147946756881789319000765030803803410728"),
+            a2("147946756881789319010696353538189108491"),
+            b2("9931322734385697763"),
+            g1("52538187511802934231"),
+            g2("782660544089080853078787955015628534158");
+
+        mpz_t K, X1, X2, C1, C2, T;
+        mpz_init(K);
+        mpz_init(X1);
+        mpz_init(X2);
+        mpz_init(C1);
+        mpz_init(C2);
+        mpz_init(T);
+
+        k.toMPZ(K);
+        MODULUS_R.toMPZ(T);
+        const bool reduced = mpz_cmp(K, T) < 0;
+
+        if (reduced) {
+            // c1 = round(b2 * k / r), c2 = round(b1 * k / r)
+            g1.toMPZ(T);
+            mpz_mul(C1, K, T);
+            mpz_fdiv_q_2exp(C1, C1, 256);
+            g2.toMPZ(T);
+            mpz_mul(C2, K, T);
+            mpz_fdiv_q_2exp(C2, C2, 256);
+
+            // k1 = k - c1 * a1 - c2 * a2
+            mpz_set(X1, K);
+            a1.toMPZ(T);
+            mpz_submul(X1, C1, T);
+            a2.toMPZ(T);
+            mpz_submul(X1, C2, T);
+
+            // k2 = c1 * b1 - c2 * b2
+            b1.toMPZ(T);
+            mpz_mul(X2, C1, T);
+            b2.toMPZ(T);
+            mpz_submul(X2, C2, T);
+
+            neg1 = mpz_sgn(X1) < 0;
+            neg2 = mpz_sgn(X2) < 0;
+            mpz_abs(X1, X1);
+            mpz_abs(X2, X2);
+
+            k1 = BigInt<M>(X1);
+            k2 = BigInt<M>(X2);
+        }
+
+        mpz_clear(K);
+        mpz_clear(X1);
+        mpz_clear(X2);
+        mpz_clear(C1);
+        mpz_clear(C2);
+        mpz_clear(T);
+
+        return reduced;
+    }
+
+private:
+    // cube roots of unity, G2 uses beta^2 so lambda is the same
+    static const Fq& endo_beta(const Fq& dummy) {
+        static const Fq a(
+            "2203960485148121921418603742825762020974279258880205651966");
+        return a;
+    }
+
+    static const Fq& endo_beta(const Fq2& dummy) {
+        static const Fq a(
+            "21888242871839275220042445260109153167277707414472061641714758635765020556616");
+        return a;
+    }
 };
 
 } // namespace snarklib
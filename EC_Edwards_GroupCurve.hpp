@@ -340,6 +340,65 @@ public:
 
         return vec;
     }
+
+    // a[i] = a[i] + b[i] with affine addition, all elements are special
+    template <typename GROUP>
+    static
+    std::vector<GROUP>& batchAddSpecial(std::vector<GROUP>& a,
+                                        const std::vector<GROUP>& b) {
+        typedef typename GROUP::BaseField T;
+
+        std::vector<T> E_vec(a.size()), H_vec(a.size()), I_vec(a.size()), HI_vec;
+        std::vector<bool> exceptional(a.size(), true);
+
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (a[i].isZero() || b[i].isZero())
+                continue;
+
+            // same as fastAddSpecial() with Z1 = 1
+            const auto
+                C = a[i].x() * b[i].x(),
+                D = a[i].y() * b[i].y();
+
+            E_vec[i] = C * D;
+            H_vec[i] = C - mul_by_a(D);
+            I_vec[i] = (a[i].x() + a[i].y()) * (b[i].x() + b[i].y()) - C - D;
+
+            // X3 = (E + d) / I and Y3 = (E - d) / H
+            if (! H_vec[i].isZero() && ! I_vec[i].isZero()) {
+                HI_vec.push_back(H_vec[i] * I_vec[i]);
+                exceptional[i] = false;
+            }
+        }
+
+        batch_invert(HI_vec);
+
+        const auto ONE = T::one();
+        const auto d = mul_by_d(ONE);
+
+        auto it = HI_vec.begin();
+
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (exceptional[i]) {
+                a[i] = a[i] + b[i];
+                a[i].toSpecial();
+
+            } else {
+                const auto
+                    X3 = (E_vec[i] + d) * (H_vec[i] * (*it)),
+                    Y3 = (E_vec[i] - d) * (I_vec[i] * (*it));
+
+                a[i] = GROUP(X3, Y3, ONE);
+
+                ++it;
+            }
+        }
+
+        return a;
+    }
+
+    // no efficient GLV endomorphism
+    static constexpr bool hasEndomorphism() { return false; }
 };
 
 } // namespace snarklib
@@ -351,6 +351,17 @@ public:
 
         return vec;
     }
+
+    // a[i] = a[i] + b[i] with affine addition, all elements are special
+    template <typename GROUP>
+    static
+    std::vector<GROUP>& batchAddSpecial(std::vector<GROUP>& a,
+                                        const std::vector<GROUP>& b) {
+        return weierstrassBatchAddSpecial(a, b);
+    }
+
+    // no efficient GLV endomorphism
+    static constexpr bool hasEndomorphism() { return false; }
 };
 
 } // namespace snarklib
@@ -373,6 +373,19 @@ Field<T, N> operator* (const Field<T, N>& a, const Field<T, N>& other)
     // Field<T, N>& operator*= (Field<T, N>&, const Field<T, N>&)
 }
 
+// array multiplication in-place: a[i * astride] *= b[i * bstride]
+// (F[p] overloads this with vector instructions)
+template <typename T, std::size_t N>
+void mul_array(Field<T, N>* a,
+               const Field<T, N>* b,
+               const std::size_t n,
+               const std::size_t astride = 1,
+               const std::size_t bstride = 1)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        a[i * astride] *= b[i * bstride];
+}
+
 // addition
 template <typename T, std::size_t N>
 Field<T, N> operator+ (const Field<T, N>& a, const Field<T, N>& other)
@@ -2,6 +2,7 @@
 #define _SNARKLIB_FP_MODEL_HPP_
 
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
@@ -389,6 +390,38 @@ public:
     // squaring is optimized with assembler code
     FpModel squared() const; // asm
 
+    // multiplication with MULX, ADCX and ADOX instructions (process
+    // wide, default is on if the processor has BMI2 and ADX, the field
+    // has 3, 4 or 5 limbs and the modulus top bit is clear)
+    static bool mulxADX() {
+        return mulxADXFlag();
+    }
+
+    // cannot be turned on without support, off uses the older code
+    static void mulxADX(const bool a) {
+        mulxADXFlag() = a && mulxADXSupported();
+    }
+
+    // array multiplication with AVX-512 IFMA instructions, eight
+    // elements at a time (process wide, default is on if the processor
+    // has AVX-512F and IFMA)
+    static bool arrayIFMA() {
+        return arrayIFMAFlag();
+    }
+
+    // cannot be turned on without support, off multiplies one at a time
+    static void arrayIFMA(const bool a) {
+        arrayIFMAFlag() = a && arrayIFMASupported();
+    }
+
+    // a[i * astride] *= b[i * bstride] for i < 8 * count, strides are
+    // in bytes and zero bstride multiplies by a constant
+    static void mulArrayIFMA(FpModel* a,
+                             const FpModel* b,
+                             const std::size_t count,
+                             const std::size_t astride,
+                             const std::size_t bstride); // asm
+
     // inversion in-place
     FpModel& invert() {
 #ifdef USE_ASSERT
@@ -500,6 +533,21 @@ private:
     }
 
     void mulReduce(const BigInt<N>& other); // asm
+    void mulxReduce(const BigInt<N>& other); // asm
+
+    static bool mulxADXSupported(); // asm
+
+    static std::atomic<bool>& mulxADXFlag() {
+        static std::atomic<bool> a(mulxADXSupported());
+        return a;
+    }
+
+    static bool arrayIFMASupported(); // asm
+
+    static std::atomic<bool>& arrayIFMAFlag() {
+        static std::atomic<bool> a(arrayIFMASupported());
+        return a;
+    }
 
     BigInt<N> m_monty;
 };
@@ -598,6 +646,30 @@ Field<FpModel<N, MODULUS>>& operator*= (Field<FpModel<N, MODULUS>>& x,
     return x;
 }
 
+// array multiplication in-place: F[p] *= F[p] for arrays
+template <mp_size_t N, const BigInt<N>& MODULUS>
+void mul_array(Field<FpModel<N, MODULUS>>* a,
+               const Field<FpModel<N, MODULUS>>* b,
+               const std::size_t n,
+               const std::size_t astride = 1,
+               const std::size_t bstride = 1) {
+    typedef Field<FpModel<N, MODULUS>> F;
+
+    std::size_t i = 0;
+
+    if (FpModel<N, MODULUS>::arrayIFMA() && n >= 8) {
+        FpModel<N, MODULUS>::mulArrayIFMA(&a[0][0],
+                                          &b[0][0],
+                                          n / 8,
+                                          astride * sizeof(F),
+                                          bstride * sizeof(F));
+        i = n - n % 8;
+    }
+
+    for (; i < n; ++i)
+        a[i * astride] *= b[i * bstride];
+}
+
 // inverse
 template <mp_size_t N, const BigInt<N>& MODULUS>
 Field<FpModel<N, MODULUS>> inverse(const Field<FpModel<N, MODULUS>>& x) {
@@ -1,6 +1,11 @@
 #ifndef _SNARKLIB_FP_MODEL_TCC_
 #define _SNARKLIB_FP_MODEL_TCC_
 
+#if defined(__x86_64__) && defined(USE_ASM)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 #include <snarklib/AsmMacros.hpp>
 #include <snarklib/FpModel.hpp>
 
@@ -239,7 +244,13 @@ FpModel<N, MODULUS> FpModel<N, MODULUS>::squared() const
 {
     /* stupid pre-processor tricks; beware */
 #if defined(__x86_64__) && defined(USE_ASM)
-    if (3 == N)
+    if (mulxADX())
+    { // MULX, ADCX and ADOX
+        auto r(*this);
+        r.mulxReduce(m_monty);
+        return r;
+    }
+    else if (3 == N)
     { // use asm-optimized Comba squaring
         mp_limb_t res[2*N];
         mp_limb_t c0, c1, c2;
@@ -289,7 +300,11 @@ void FpModel<N, MODULUS>::mulReduce(const BigInt<N>& other)
 {
     /* stupid pre-processor tricks; beware */
 #if defined(__x86_64__) && defined(USE_ASM)
-    if (3 == N)
+    if (mulxADX())
+    { // MULX, ADCX and ADOX
+        mulxReduce(other);
+    }
+    else if (3 == N)
     { // Use asm-optimized Comba multiplication and reduction
         mp_limb_t res[2*N];
         mp_limb_t c0, c1, c2;
@@ -466,6 +481,451 @@ void FpModel<N, MODULUS>::mulReduce(const BigInt<N>& other)
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// mulxADXSupported
+//
+
+template <mp_size_t N, const BigInt<N>& MODULUS>
+bool FpModel<N, MODULUS>::mulxADXSupported()
+{
+#if defined(__x86_64__) && defined(USE_ASM)
+    // accumulator fits in N + 1 limbs only if the modulus top bit is clear
+    if ((3 != N && 4 != N && 5 != N) ||
+        (MODULUS.data()[N - 1] >> 63))
+    {
+        return false;
+    }
+
+    // structured extended feature flags, EBX bit 8 is BMI2 and bit 19 is ADX
+    if (__get_cpuid_max(0, nullptr) < 7) return false;
+
+    unsigned int eax, ebx, ecx, edx;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+    return (ebx & (1u << 8)) && (ebx & (1u << 19));
+#else
+    return false;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// mulxReduce
+//
+
+template <mp_size_t N, const BigInt<N>& MODULUS>
+void FpModel<N, MODULUS>::mulxReduce(const BigInt<N>& other)
+{
+#if defined(__x86_64__) && defined(USE_ASM)
+    // CIOS with the product and reduction of each outer iteration in
+    // two interleaved carry chains, result written to m_monty only at
+    // the end so other may alias it
+    if (3 == N)
+    {
+        __asm__ (MULX_LOADB(0)
+                 MULX_FIRSTMUL("r8", "r9")
+                 MULX_FIRSTNEXT(8, "r9", "r10")
+                 MULX_FIRSTNEXT(16, "r10", "r11")
+                 MULX_CARRY("r11")
+                 MULX_REDUCE("r8")
+                 MULX_ADDMUL("M", 0, "r8", "r9")
+                 MULX_ADDMUL("M", 8, "r9", "r10")
+                 MULX_ADDMUL("M", 16, "r10", "r11")
+                 MULX_CARRY("r11")
+                 MULX_LOADB(8)
+                 MULX_ADDMUL("A", 0, "r9", "r10")
+                 MULX_ADDMUL("A", 8, "r10", "r11")
+                 MULX_ADDMUL("A", 16, "r11", "r8")
+                 MULX_CARRY("r8")
+                 MULX_REDUCE("r9")
+                 MULX_ADDMUL("M", 0, "r9", "r10")
+                 MULX_ADDMUL("M", 8, "r10", "r11")
+                 MULX_ADDMUL("M", 16, "r11", "r8")
+                 MULX_CARRY("r8")
+                 MULX_LOADB(16)
+                 MULX_ADDMUL("A", 0, "r10", "r11")
+                 MULX_ADDMUL("A", 8, "r11", "r8")
+                 MULX_ADDMUL("A", 16, "r8", "r9")
+                 MULX_CARRY("r9")
+                 MULX_REDUCE("r10")
+                 MULX_ADDMUL("M", 0, "r10", "r11")
+                 MULX_ADDMUL("M", 8, "r11", "r8")
+                 MULX_ADDMUL("M", 16, "r8", "r9")
+                 MULX_CARRY("r9")
+                 MULX_STORE(0, "r11")
+                 MULX_STORE(8, "r8")
+                 MULX_STORE(16, "r9")
+                 MULX_FIRSTSUB("r11")
+                 MULX_NEXTSUB(8, "r8")
+                 MULX_NEXTSUB(16, "r9")
+                 MULX_RESTORE(0, "r11")
+                 MULX_RESTORE(8, "r8")
+                 MULX_RESTORE(16, "r9")
+                 MULX_STORE(0, "r11")
+                 MULX_STORE(8, "r8")
+                 MULX_STORE(16, "r9")
+                 :
+                 : [A] "r" (m_monty.data()), [B] "r" (other.data()), [M] "r" (MODULUS.data()),
+                   [inv] "r" (Fp::params.inv()), [zero] "r" (mp_limb_t(0))
+                 : "cc", "memory", "%rax", "%rcx", "%rdx", "%r8", "%r9", "%r10", "%r11"
+        );
+    }
+    else if (4 == N)
+    {
+        __asm__ (MULX_LOADB(0)
+                 MULX_FIRSTMUL("r8", "r9")
+                 MULX_FIRSTNEXT(8, "r9", "r10")
+                 MULX_FIRSTNEXT(16, "r10", "r11")
+                 MULX_FIRSTNEXT(24, "r11", "r12")
+                 MULX_CARRY("r12")
+                 MULX_REDUCE("r8")
+                 MULX_ADDMUL("M", 0, "r8", "r9")
+                 MULX_ADDMUL("M", 8, "r9", "r10")
+                 MULX_ADDMUL("M", 16, "r10", "r11")
+                 MULX_ADDMUL("M", 24, "r11", "r12")
+                 MULX_CARRY("r12")
+                 MULX_LOADB(8)
+                 MULX_ADDMUL("A", 0, "r9", "r10")
+                 MULX_ADDMUL("A", 8, "r10", "r11")
+                 MULX_ADDMUL("A", 16, "r11", "r12")
+                 MULX_ADDMUL("A", 24, "r12", "r8")
+                 MULX_CARRY("r8")
+                 MULX_REDUCE("r9")
+                 MULX_ADDMUL("M", 0, "r9", "r10")
+                 MULX_ADDMUL("M", 8, "r10", "r11")
+                 MULX_ADDMUL("M", 16, "r11", "r12")
+                 MULX_ADDMUL("M", 24, "r12", "r8")
+                 MULX_CARRY("r8")
+                 MULX_LOADB(16)
+                 MULX_ADDMUL("A", 0, "r10", "r11")
+                 MULX_ADDMUL("A", 8, "r11", "r12")
+                 MULX_ADDMUL("A", 16, "r12", "r8")
+                 MULX_ADDMUL("A", 24, "r8", "r9")
+                 MULX_CARRY("r9")
+                 MULX_REDUCE("r10")
+                 MULX_ADDMUL("M", 0, "r10", "r11")
+                 MULX_ADDMUL("M", 8, "r11", "r12")
+                 MULX_ADDMUL("M", 16, "r12", "r8")
+                 MULX_ADDMUL("M", 24, "r8", "r9")
+                 MULX_CARRY("r9")
+                 MULX_LOADB(24)
+                 MULX_ADDMUL("A", 0, "r11", "r12")
+                 MULX_ADDMUL("A", 8, "r12", "r8")
+                 MULX_ADDMUL("A", 16, "r8", "r9")
+                 MULX_ADDMUL("A", 24, "r9", "r10")
+                 MULX_CARRY("r10")
+                 MULX_REDUCE("r11")
+                 MULX_ADDMUL("M", 0, "r11", "r12")
+                 MULX_ADDMUL("M", 8, "r12", "r8")
+                 MULX_ADDMUL("M", 16, "r8", "r9")
+                 MULX_ADDMUL("M", 24, "r9", "r10")
+                 MULX_CARRY("r10")
+                 MULX_STORE(0, "r12")
+                 MULX_STORE(8, "r8")
+                 MULX_STORE(16, "r9")
+                 MULX_STORE(24, "r10")
+                 MULX_FIRSTSUB("r12")
+                 MULX_NEXTSUB(8, "r8")
+                 MULX_NEXTSUB(16, "r9")
+                 MULX_NEXTSUB(24, "r10")
+                 MULX_RESTORE(0, "r12")
+                 MULX_RESTORE(8, "r8")
+                 MULX_RESTORE(16, "r9")
+                 MULX_RESTORE(24, "r10")
+                 MULX_STORE(0, "r12")
+                 MULX_STORE(8, "r8")
+                 MULX_STORE(16, "r9")
+                 MULX_STORE(24, "r10")
+                 :
+                 : [A] "r" (m_monty.data()), [B] "r" (other.data()), [M] "r" (MODULUS.data()),
+                   [inv] "r" (Fp::params.inv()), [zero] "r" (mp_limb_t(0))
+                 : "cc", "memory", "%rax", "%rcx", "%rdx", "%r8", "%r9", "%r10", "%r11", "%r12"
+        );
+    }
+    else if (5 == N)
+    {
+        __asm__ (MULX_LOADB(0)
+                 MULX_FIRSTMUL("r8", "r9")
+                 MULX_FIRSTNEXT(8, "r9", "r10")
+                 MULX_FIRSTNEXT(16, "r10", "r11")
+                 MULX_FIRSTNEXT(24, "r11", "r12")
+                 MULX_FIRSTNEXT(32, "r12", "r13")
+                 MULX_CARRY("r13")
+                 MULX_REDUCE("r8")
+                 MULX_ADDMUL("M", 0, "r8", "r9")
+                 MULX_ADDMUL("M", 8, "r9", "r10")
+                 MULX_ADDMUL("M", 16, "r10", "r11")
+                 MULX_ADDMUL("M", 24, "r11", "r12")
+                 MULX_ADDMUL("M", 32, "r12", "r13")
+                 MULX_CARRY("r13")
+                 MULX_LOADB(8)
+                 MULX_ADDMUL("A", 0, "r9", "r10")
+                 MULX_ADDMUL("A", 8, "r10", "r11")
+                 MULX_ADDMUL("A", 16, "r11", "r12")
+                 MULX_ADDMUL("A", 24, "r12", "r13")
+                 MULX_ADDMUL("A", 32, "r13", "r8")
+                 MULX_CARRY("r8")
+                 MULX_REDUCE("r9")
+                 MULX_ADDMUL("M", 0, "r9", "r10")
+                 MULX_ADDMUL("M", 8, "r10", "r11")
+                 MULX_ADDMUL("M", 16, "r11", "r12")
+                 MULX_ADDMUL("M", 24, "r12", "r13")
+                 MULX_ADDMUL("M", 32, "r13", "r8")
+                 MULX_CARRY("r8")
+                 MULX_LOADB(16)
+                 MULX_ADDMUL("A", 0, "r10", "r11")
+                 MULX_ADDMUL("A", 8, "r11", "r12")
+                 MULX_ADDMUL("A", 16, "r12", "r13")
+                 MULX_ADDMUL("A", 24, "r13", "r8")
+                 MULX_ADDMUL("A", 32, "r8", "r9")
+                 MULX_CARRY("r9")
+                 MULX_REDUCE("r10")
+                 MULX_ADDMUL("M", 0, "r10", "r11")
+                 MULX_ADDMUL("M", 8, "r11", "r12")
+                 MULX_ADDMUL("M", 16, "r12", "r13")
+                 MULX_ADDMUL("M", 24, "r13", "r8")
+                 MULX_ADDMUL("M", 32, "r8", "r9")
+                 MULX_CARRY("r9")
+                 MULX_LOADB(24)
+                 MULX_ADDMUL("A", 0, "r11", "r12")
+                 MULX_ADDMUL("A", 8, "r12", "r13")
+                 MULX_ADDMUL("A", 16, "r13", "r8")
+                 MULX_ADDMUL("A", 24, "r8", "r9")
+                 MULX_ADDMUL("A", 32, "r9", "r10")
+                 MULX_CARRY("r10")
+                 MULX_REDUCE("r11")
+                 MULX_ADDMUL("M", 0, "r11", "r12")
+                 MULX_ADDMUL("M", 8, "r12", "r13")
+                 MULX_ADDMUL("M", 16, "r13", "r8")
+                 MULX_ADDMUL("M", 24, "r8", "r9")
+                 MULX_ADDMUL("M", 32, "r9", "r10")
+                 MULX_CARRY("r10")
+                 MULX_LOADB(32)
+                 MULX_ADDMUL("A", 0, "r12", "r13")
+                 MULX_ADDMUL("A", 8, "r13", "r8")
+                 MULX_ADDMUL("A", 16, "r8", "r9")
+                 MULX_ADDMUL("A", 24, "r9", "r10")
+                 MULX_ADDMUL("A", 32, "r10", "r11")
+                 MULX_CARRY("r11")
+                 MULX_REDUCE("r12")
+                 MULX_ADDMUL("M", 0, "r12", "r13")
+                 MULX_ADDMUL("M", 8, "r13", "r8")
+                 MULX_ADDMUL("M", 16, "r8", "r9")
+                 MULX_ADDMUL("M", 24, "r9", "r10")
+                 MULX_ADDMUL("M", 32, "r10", "r11")
+                 MULX_CARRY("r11")
+                 MULX_STORE(0, "r13")
+                 MULX_STORE(8, "r8")
+                 MULX_STORE(16, "r9")
+                 MULX_STORE(24, "r10")
+                 MULX_STORE(32, "r11")
+                 MULX_FIRSTSUB("r13")
+                 MULX_NEXTSUB(8, "r8")
+                 MULX_NEXTSUB(16, "r9")
+                 MULX_NEXTSUB(24, "r10")
+                 MULX_NEXTSUB(32, "r11")
+                 MULX_RESTORE(0, "r13")
+                 MULX_RESTORE(8, "r8")
+                 MULX_RESTORE(16, "r9")
+                 MULX_RESTORE(24, "r10")
+                 MULX_RESTORE(32, "r11")
+                 MULX_STORE(0, "r13")
+                 MULX_STORE(8, "r8")
+                 MULX_STORE(16, "r9")
+                 MULX_STORE(24, "r10")
+                 MULX_STORE(32, "r11")
+                 :
+                 : [A] "r" (m_monty.data()), [B] "r" (other.data()), [M] "r" (MODULUS.data()),
+                   [inv] "r" (Fp::params.inv()), [zero] "r" (mp_limb_t(0))
+                 : "cc", "memory", "%rax", "%rcx", "%rdx", "%r8", "%r9", "%r10", "%r11", "%r12", "%r13"
+        );
+    }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// arrayIFMASupported
+//
+
+template <mp_size_t N, const BigInt<N>& MODULUS>
+bool FpModel<N, MODULUS>::arrayIFMASupported()
+{
+#if defined(__x86_64__) && defined(USE_ASM)
+    if (__get_cpuid_max(0, nullptr) < 7) return false;
+
+    unsigned int eax, ebx, ecx, edx;
+
+    // ECX bit 27 is OSXSAVE
+    __cpuid(1, eax, ebx, ecx, edx);
+    if (! (ecx & (1u << 27))) return false;
+
+    // operating system saves SSE, AVX and AVX-512 state (XCR0 bits 1, 2, 5, 6, 7)
+    unsigned int xcr0, xcr0hi;
+    __asm__ ("xgetbv" : "=a" (xcr0), "=d" (xcr0hi) : "c" (0));
+    if (0xe6 != (xcr0 & 0xe6)) return false;
+
+    // EBX bit 16 is AVX-512F and bit 21 is AVX-512 IFMA
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+    return (ebx & (1u << 16)) && (ebx & (1u << 21));
+#else
+    return false;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// mulArrayIFMA
+//
+
+template <mp_size_t N, const BigInt<N>& MODULUS>
+#if defined(__x86_64__) && defined(USE_ASM)
+__attribute__ ((target ("avx512f,avx512ifma")))
+#endif
+void FpModel<N, MODULUS>::mulArrayIFMA(FpModel* a,
+                                       const FpModel* b,
+                                       const std::size_t count,
+                                       const std::size_t astride,
+                                       const std::size_t bstride)
+{
+#if defined(__x86_64__) && defined(USE_ASM)
+    // Montgomery multiplication of eight elements in the lanes of
+    // 52-bit limbs. The last reduction step is only W bits so the
+    // product is divided by 2^(64 * N) the same as mulReduce().
+    const std::size_t
+        L = (64 * N + 51) / 52,
+        W = 64 * N - 52 * (L - 1);
+
+    const __m512i
+        zero = _mm512_setzero_si512(),
+        mask = _mm512_set1_epi64((1ull << 52) - 1),
+        maskW = _mm512_set1_epi64((1ull << W) - 1),
+        inv = _mm512_set1_epi64(Fp::params.inv());
+
+    // 52-bit limb j starts in 64-bit limb j * 52 / 64 and may continue
+    // into the next one
+    const auto limb = [] (const std::size_t j) { return 52 * j / 64; };
+    const auto shift = [] (const std::size_t j) { return 52 * j % 64; };
+    const auto split = [] (const std::size_t j) {
+        return 52 * j % 64 > 12 && 52 * j / 64 + 1 < std::size_t(N);
+    };
+
+    __m512i M[L];
+    for (std::size_t j = 0; j < L; ++j) {
+        mp_limb_t u = MODULUS.data()[limb(j)] >> shift(j);
+        if (split(j)) u |= MODULUS.data()[limb(j) + 1] << (64 - shift(j));
+
+        M[j] = _mm512_set1_epi64(u & ((1ull << 52) - 1));
+    }
+
+    __m512i index[2];
+    for (std::size_t k = 0; k < 2; ++k) {
+        const long long s = k ? bstride : astride;
+        index[k] = _mm512_set_epi64(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+    }
+
+    // loops over limbs must be unrolled so limbs stay in registers,
+    // -O2 does not do that by itself
+    for (std::size_t c = 0; c < count; ++c) {
+        char* const pa = reinterpret_cast<char*>(a) + 8 * c * astride;
+        const char* const pb = reinterpret_cast<const char*>(b) + 8 * c * bstride;
+
+        // gather operands into 52-bit limbs
+        __m512i X[2][L];
+#pragma GCC unroll 2
+        for (std::size_t k = 0; k < 2; ++k) {
+            __m512i x[N];
+#pragma GCC unroll 8
+            for (std::size_t q = 0; q < std::size_t(N); ++q)
+                x[q] = _mm512_i64gather_epi64(index[k], (k ? pb : pa) + 8 * q, 1);
+
+#pragma GCC unroll 8
+            for (std::size_t j = 0; j < L; ++j) {
+                __m512i u = _mm512_srlv_epi64(x[limb(j)], _mm512_set1_epi64(shift(j)));
+                if (split(j))
+                    u = _mm512_or_si512(u, _mm512_sllv_epi64(x[limb(j) + 1],
+                                                             _mm512_set1_epi64(64 - shift(j))));
+
+                X[k][j] = _mm512_and_si512(u, mask);
+            }
+        }
+
+        // product, columns are not normalized
+        __m512i T[2 * L];
+#pragma GCC unroll 16
+        for (std::size_t j = 0; j < 2 * L; ++j)
+            T[j] = zero;
+
+#pragma GCC unroll 8
+        for (std::size_t i = 0; i < L; ++i) {
+#pragma GCC unroll 8
+            for (std::size_t j = 0; j < L; ++j) {
+                T[i + j] = _mm512_madd52lo_epu64(T[i + j], X[0][i], X[1][j]);
+                T[i + j + 1] = _mm512_madd52hi_epu64(T[i + j + 1], X[0][i], X[1][j]);
+            }
+        }
+
+        // Montgomery reduction one limb at a time, then carries
+#pragma GCC unroll 8
+        for (std::size_t k = 0; k < L; ++k) {
+            if (k) T[k] = _mm512_add_epi64(T[k], _mm512_srli_epi64(T[k - 1], 52));
+
+            __m512i m = _mm512_madd52lo_epu64(zero, T[k], inv);
+            if (L - 1 == k) m = _mm512_and_si512(m, maskW);
+
+#pragma GCC unroll 8
+            for (std::size_t j = 0; j < L; ++j) {
+                T[k + j] = _mm512_madd52lo_epu64(T[k + j], m, M[j]);
+                T[k + j + 1] = _mm512_madd52hi_epu64(T[k + j + 1], m, M[j]);
+            }
+        }
+
+#pragma GCC unroll 8
+        for (std::size_t j = L - 1; j < 2 * L - 1; ++j) {
+            T[j + 1] = _mm512_add_epi64(T[j + 1], _mm512_srli_epi64(T[j], 52));
+            T[j] = _mm512_and_si512(T[j], mask);
+        }
+
+        // Z < 2 * MODULUS is the upper limbs shifted down W bits, then
+        // the modulus is subtracted unless that borrows
+        __m512i Z[L], D[L], s = zero;
+#pragma GCC unroll 8
+        for (std::size_t j = 0; j < L; ++j) {
+            Z[j] = _mm512_and_si512(
+                _mm512_or_si512(_mm512_srlv_epi64(T[L - 1 + j], _mm512_set1_epi64(W)),
+                                _mm512_sllv_epi64(T[L + j], _mm512_set1_epi64(52 - W))),
+                mask);
+
+            s = _mm512_add_epi64(_mm512_sub_epi64(Z[j], M[j]),
+                                 _mm512_srai_epi64(s, 52));
+            D[j] = _mm512_and_si512(s, mask);
+        }
+
+        const __mmask8 borrow = _mm512_cmplt_epi64_mask(s, zero);
+
+        // scatter result from 52-bit limbs
+        __m512i x[N];
+#pragma GCC unroll 8
+        for (std::size_t q = 0; q < std::size_t(N); ++q)
+            x[q] = zero;
+
+#pragma GCC unroll 8
+        for (std::size_t j = 0; j < L; ++j) {
+            const __m512i u = _mm512_mask_blend_epi64(borrow, D[j], Z[j]);
+
+            x[limb(j)] = _mm512_or_si512(x[limb(j)],
+                                         _mm512_sllv_epi64(u, _mm512_set1_epi64(shift(j))));
+
+            if (split(j))
+                x[limb(j) + 1] = _mm512_or_si512(x[limb(j) + 1],
+                                                 _mm512_srlv_epi64(u, _mm512_set1_epi64(64 - shift(j))));
+        }
+
+#pragma GCC unroll 8
+        for (std::size_t q = 0; q < std::size_t(N); ++q)
+            _mm512_i64scatter_epi64(pa + 8 * q, index[0], x[q], 1);
+    }
+#endif
+}
+
 #undef COMMA
 
 } // namespace snarklib
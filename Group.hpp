@@ -8,11 +8,13 @@
 #include <istream>
 #include <ostream>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
 #include <snarklib/AuxSTL.hpp>
 #include <snarklib/BigInt.hpp>
 #include <snarklib/FpModel.hpp>
+#include <snarklib/Util.hpp>
 
 namespace snarklib {
 
@@ -150,6 +152,15 @@ public:
         return CURVE::dbl(m_X, m_Y, m_Z, *this);
     }
 
+    // GLV endomorphism, only if curve has one
+    static constexpr bool hasEndomorphism() {
+        return CURVE::hasEndomorphism();
+    }
+
+    Group endomorphism() const {
+        return CURVE::endomorphism(*this);
+    }
+
     bool wellFormed() const {
         return CURVE::wellFormed(m_X, m_Y, m_Z);
     }
@@ -454,12 +465,119 @@ Group<BASE, SCALAR, CURVE> fastAddSpecial(const Group<BASE, SCALAR, CURVE>& a,
         a);
 }
 
+// k1 * P + k2 * Q with wNAF, doublings are shared
+template <mp_size_t N, typename T>
+T glvExp(const BigInt<N>& k1, const T& P,
+         const BigInt<N>& k2, const T& Q)
+{
+    const std::size_t scalarBits = std::max(k1.numBits(), k2.numBits());
+
+    // same window size as wnafExp()
+    std::size_t w = 1;
+    for (long i = T::params.wnaf_window_table().size() - 1; i >= 0; --i) {
+        if (scalarBits >= T::params.wnaf_window_table()[i]) {
+            w = i + 1;
+            break;
+        }
+    }
+
+    const auto
+        NAF1 = find_wNAF(w, k1),
+        NAF2 = find_wNAF(w, k2);
+
+    // odd multiples: P, 3 * P, ..., (2^w - 1) * P and same for Q
+    std::vector<T> table1(1u << (w - 1)), table2(1u << (w - 1));
+
+    auto tmp1 = P, tmp2 = Q;
+    const auto dbl1 = P.dbl(), dbl2 = Q.dbl();
+    for (std::size_t j = 0; j < table1.size(); ++j) {
+        table1[j] = tmp1;
+        table2[j] = tmp2;
+        tmp1 = tmp1 + dbl1;
+        tmp2 = tmp2 + dbl2;
+    }
+
+    auto res = T::zero();
+
+    bool found_nonzero = false;
+    for (long j = NAF1.size() - 1; j >= 0; --j) {
+        if (found_nonzero) {
+            res = res.dbl();
+        }
+
+        if (NAF1[j] != 0) {
+            found_nonzero = true;
+            res = (NAF1[j] > 0)
+                ? res + table1[NAF1[j] / 2]
+                : res - table1[(-NAF1[j]) / 2];
+        }
+
+        if (NAF2[j] != 0) {
+            found_nonzero = true;
+            res = (NAF2[j] > 0)
+                ? res + table2[NAF2[j] / 2]
+                : res - table2[(-NAF2[j]) / 2];
+        }
+    }
+
+    return res;
+}
+
+template <mp_size_t N,
+          typename BASE, typename SCALAR, typename CURVE>
+bool glvPower(const BigInt<N>& exponent,
+              const Group<BASE, SCALAR, CURVE>& base,
+              Group<BASE, SCALAR, CURVE>& res,
+              std::false_type) {
+    return false;
+}
+
+template <mp_size_t N,
+          typename BASE, typename SCALAR, typename CURVE>
+bool glvPower(const BigInt<N>& exponent,
+              const Group<BASE, SCALAR, CURVE>& base,
+              Group<BASE, SCALAR, CURVE>& res,
+              std::true_type) {
+    BigInt<N> k1, k2;
+    bool neg1, neg2;
+
+    // short exponents and exponents not reduced modulo r
+    if (2 * exponent.numBits() <= SCALAR::sizeInBits() ||
+        ! CURVE::glvDecompose(exponent, k1, neg1, k2, neg2)) {
+        return false;
+    }
+
+    const auto Q = base.endomorphism();
+
+    res = glvExp(k1, neg1 ? -base : base,
+                 k2, neg2 ? -Q : Q);
+
+    return true;
+}
+
+// res = exponent * base with two half length exponents if the curve
+// has a GLV endomorphism, returns false if not
+template <mp_size_t N,
+          typename BASE, typename SCALAR, typename CURVE>
+bool glvPower(const BigInt<N>& exponent,
+              const Group<BASE, SCALAR, CURVE>& base,
+              Group<BASE, SCALAR, CURVE>& res) {
+    return glvPower(exponent,
+                    base,
+                    res,
+                    std::integral_constant<bool, CURVE::hasEndomorphism()>());
+}
+
 template <mp_size_t N,
           typename BASE, typename SCALAR, typename CURVE>
 Group<BASE, SCALAR, CURVE> operator* (const BigInt<N>& exponent,
                                       const Group<BASE, SCALAR, CURVE>& base) {
-    return power(exponent, base); // group version: base follows power
-                                  // this uses dbl() and operator+
+    Group<BASE, SCALAR, CURVE> res;
+
+    return glvPower(exponent, base, res)
+        ? res
+        : power(exponent, base); // group version: base follows power
+                                 // this uses dbl() and operator+
 }
 
 template <mp_size_t N, const BigInt<N>& MODULUS,
@@ -483,6 +601,56 @@ batchSpecial(std::vector<Group<BASE, SCALAR, CURVE>>& vec) {
     return CURVE::batchSpecial(vec);
 }
 
+// batch addition of special elements, a[i] = a[i] + b[i] (result is special)
+template <typename BASE, typename SCALAR, typename CURVE>
+std::vector<Group<BASE, SCALAR, CURVE>>&
+batchAddSpecial(std::vector<Group<BASE, SCALAR, CURVE>>& a,
+                const std::vector<Group<BASE, SCALAR, CURVE>>& b) {
+    return CURVE::batchAddSpecial(a, b);
+}
+
+// batch addition of special elements on a short Weierstrass curve with
+// affine chord formulas, one field inversion shared by all elements
+template <typename GROUP>
+std::vector<GROUP>& weierstrassBatchAddSpecial(std::vector<GROUP>& a,
+                                               const std::vector<GROUP>& b) {
+    // zero, doubling, or inverse elements
+    const auto isExceptional = [&a, &b] (const std::size_t i) {
+        return a[i].isZero() || b[i].isZero() || a[i].x() == b[i].x();
+    };
+
+    // chord slope denominators (x2 - x1)
+    std::vector<typename GROUP::BaseField> dX_vec;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (! isExceptional(i))
+            dX_vec.push_back(b[i].x() - a[i].x());
+    }
+
+    batch_invert(dX_vec);
+
+    const auto ONE = GROUP::BaseField::one();
+
+    auto it = dX_vec.begin();
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (isExceptional(i)) {
+            a[i] = a[i] + b[i];
+            a[i].toSpecial();
+
+        } else {
+            const auto lambda = (b[i].y() - a[i].y()) * (*it);
+            const auto X3 = squared(lambda) - a[i].x() - b[i].x();
+            const auto Y3 = lambda * (a[i].x() - X3) - a[i].y();
+
+            a[i] = GROUP(X3, Y3, ONE);
+
+            ++it;
+        }
+    }
+
+    return a;
+}
+
 } // namespace snarklib
 
 #endif
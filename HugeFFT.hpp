@@ -0,0 +1,443 @@
+#ifndef _SNARKLIB_HUGE_FFT_HPP_
+#define _SNARKLIB_HUGE_FFT_HPP_
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <snarklib/AuxSTL.hpp>
+#include <snarklib/IndexSpace.hpp>
+#include <snarklib/LagrangeFFTX.hpp>
+#include <snarklib/Parallel.hpp>
+#include <snarklib/Util.hpp>
+
+namespace snarklib {
+
+////////////////////////////////////////////////////////////////////////////////
+// radix-2 FFT of a vector on disk
+// The vector is block partitioned into files as written by
+// write_blockvector_raw(). Four-step algorithm: the numBlocks x
+// blockSize matrix of files is transformed down columns, then along
+// rows, then transposed. About one block of elements is in memory.
+// Each pass keeps the numBlocks files open.
+//
+
+template <typename T>
+class HugeFFT
+{
+public:
+    // vector of size n in files filePrefix0 ... filePrefix(numBlocks - 1)
+    HugeFFT(const std::string& filePrefix,
+            const std::size_t n,
+            const std::size_t numBlocks)
+        : m_filePrefix(filePrefix),
+          m_space(space(n, numBlocks)),
+          m_numBlocks(numBlocks),
+          m_blockSize(n / numBlocks),
+          m_elementBytes(elementBytes()),
+          m_offset(numBlocks, 0),
+          m_error(! supported(n, numBlocks))
+    {
+#ifdef USE_ASSERT
+        assert(supported(n, numBlocks));
+#endif
+    }
+
+    // basic radix-2 domain with columns no longer than rows
+    static bool supported(const std::size_t n, const std::size_t numBlocks) {
+        return
+            n == (std::size_t(1) << ceil_log2(n)) &&
+            ceil_log2(n) <= T::params.s() &&
+            numBlocks == (std::size_t(1) << ceil_log2(numBlocks)) &&
+            numBlocks > 1 && numBlocks * numBlocks <= n;
+    }
+
+    // block partition of the files
+    static IndexSpace<1> space(const std::size_t n, const std::size_t numBlocks) {
+        IndexSpace<1> a(n);
+        a.blockPartition(std::array<std::size_t, 1>{ numBlocks });
+        return a;
+    }
+
+    // true if the size is not supported or there was an error while
+    // reading or writing files
+    bool operator! () const { return m_error; }
+
+    const std::string& filePrefix() const { return m_filePrefix; }
+    const IndexSpace<1>& space() const { return m_space; }
+    std::size_t size() const { return m_space.globalID()[0]; }
+    std::size_t numBlocks() const { return m_numBlocks; }
+
+    bool FFT() {
+        return transform(false, T::one(), T::one());
+    }
+
+    bool iFFT() {
+        return transform(true, T::one(), T::one());
+    }
+
+    bool cosetFFT(const T& g) {
+        return transform(false, g, T::one());
+    }
+
+    bool icosetFFT(const T& g) {
+        return transform(true, T::one(), inverse(g));
+    }
+
+    // Z is constant on the coset of a basic radix-2 domain
+    bool divide_by_Z_on_coset() {
+        const T coset = T::params.multiplicative_generator();
+        const T Z_inverse_at_coset = inverse((coset ^ size()) - T::one());
+
+        return mapLambda(
+            [&Z_inverse_at_coset] (BlockVector<T>& a) -> bool {
+                for (auto& x : a.lvec())
+                    x *= Z_inverse_at_coset;
+
+                return true; // write back to disk
+            });
+    }
+
+    bool readBlock(const std::size_t block, BlockVector<T>& a) const {
+        std::ifstream ifs(fileName(block), std::ios::binary);
+
+        return
+            !!ifs &&
+            a.marshal_in(
+                ifs,
+                [] (std::istream& i, T& x) { return x.marshal_in_raw(i); }) &&
+            a.space() == m_space &&
+            a.block()[0] == block;
+    }
+
+    bool writeBlock(const BlockVector<T>& a) const {
+#ifdef USE_ASSERT
+        assert(a.space() == m_space);
+#endif
+
+        std::ofstream ofs(fileName(a.block()[0]), std::ios::binary);
+        if (!ofs) return false; // failure
+
+        a.marshal_out(
+            ofs,
+            [] (std::ostream& o, const T& x) { x.marshal_out_raw(o); });
+
+        return !!ofs;
+    }
+
+    // read each block, write back to disk if func returns true
+    bool mapLambda(std::function<bool (BlockVector<T>&)> func) {
+        for (std::size_t block = 0; block < m_numBlocks; ++block) {
+            BlockVector<T> a;
+
+            if (! readBlock(block, a) ||
+                (func(a) && ! writeBlock(a)))
+            {
+                return !(m_error = true); // failure
+            }
+        }
+
+        return true; // ok
+    }
+
+private:
+    std::string fileName(const std::size_t block) const {
+        std::stringstream ss;
+        ss << m_filePrefix << block;
+        return ss.str();
+    }
+
+    static std::size_t elementBytes() {
+        std::stringstream ss;
+        T::zero().marshal_out_raw(ss);
+        return ss.str().size();
+    }
+
+    // primitive root of unity for the whole vector
+    T root() const {
+        T omega = T::params.root_of_unity();
+        for (std::size_t i = T::params.s(); i > ceil_log2(size()); --i) {
+            omega *= omega;
+        }
+
+        return omega;
+    }
+
+    // elements follow the index space and block number text
+    bool loadOffsets() {
+        for (std::size_t block = 0; block < m_numBlocks; ++block) {
+            std::ifstream ifs(fileName(block), std::ios::binary);
+
+            IndexSpace<1> sp;
+            std::size_t b;
+            char c;
+
+            if (!ifs ||
+                ! sp.marshal_in(ifs) || !(sp == m_space) ||
+                !(ifs >> b) || (block != b) ||
+                !ifs.get(c) || (' ' != c))
+            {
+                return false; // failure
+            }
+
+            m_offset[block] = ifs.tellg();
+        }
+
+        return true; // ok
+    }
+
+    // files of all blocks are opened once and stay open for a pass
+    typedef std::vector<std::unique_ptr<std::fstream>> BlockFiles;
+
+    bool openBlocks(BlockFiles& files) const {
+        files.clear();
+
+        for (std::size_t block = 0; block < m_numBlocks; ++block) {
+            files.emplace_back(
+                new std::fstream(fileName(block),
+                                 std::ios::in | std::ios::out | std::ios::binary));
+
+            if (! *files.back()) return false; // failure
+        }
+
+        return true; // ok
+    }
+
+    // flushes and closes the files of a pass
+    static bool closeBlocks(BlockFiles& files) {
+        bool ok = true;
+
+        for (auto& f : files) {
+            f->close();
+            ok = ok && !!*f;
+        }
+
+        files.clear();
+
+        return ok;
+    }
+
+    // elements [start, start + count) of a block
+    bool readRun(std::fstream& fs,
+                 const std::size_t block,
+                 const std::size_t start,
+                 const std::size_t count,
+                 T* a) const {
+        if (!fs.seekg(m_offset[block] + start * m_elementBytes)) {
+            return false; // failure
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            if (! a[i].marshal_in_raw(fs)) return false;
+        }
+
+        return true; // ok
+    }
+
+    bool writeRun(std::fstream& fs,
+                  const std::size_t block,
+                  const std::size_t start,
+                  const std::size_t count,
+                  const T* a) const {
+        if (!fs.seekp(m_offset[block] + start * m_elementBytes)) {
+            return false; // failure
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+            a[i].marshal_out_raw(fs);
+
+        return !!fs;
+    }
+
+    // element k is multiplied by gIn ^ k before and gOut ^ k after,
+    // inverse transforms scale by 1 / n
+    bool transform(const bool inv, const T& gIn, const T& gOut) {
+        if (m_error ||
+            ! loadOffsets() ||
+            ! columnFFT(inv, gIn) ||
+            ! rowFFT(inv) ||
+            ! transposeBlocks(gOut))
+        {
+            return !(m_error = true); // failure
+        }
+
+        return true; // ok
+    }
+
+    // FFTs of size numBlocks down columns (elements l, blockSize + l,...)
+    // and twiddle by omega ^ (column * row), in chunks of columns that
+    // together are one block
+    bool columnFFT(const bool inv, const T& gIn) {
+        const std::size_t
+            B = m_numBlocks,
+            L = m_blockSize,
+            width = L / B;
+
+        const LagrangeFFT<T> colFFT(B);
+
+        const T
+            omega = inv ? inverse(root()) : root(),
+            gInL = gIn ^ L;
+
+        std::vector<std::vector<T>> cols(width, std::vector<T>(B));
+        std::vector<T> run(width);
+
+        std::vector<std::vector<T>*> ptrs;
+        for (auto& c : cols)
+            ptrs.push_back(&c);
+
+        BlockFiles files;
+        if (! openBlocks(files)) return false;
+
+        for (std::size_t l0 = 0; l0 < L; l0 += width) {
+            for (std::size_t b = 0; b < B; ++b) {
+                if (! readRun(*files[b], b, l0, width, run.data())) return false;
+
+                for (std::size_t c = 0; c < width; ++c)
+                    cols[c][b] = run[c];
+            }
+
+            // coset power of element b * L + l is (gIn ^ l) * (gIn ^ L) ^ b
+            if (T::one() != gIn) {
+                Parallel::mapLambda(
+                    width,
+                    [&] (const std::size_t c) {
+                        T u = gIn ^ (l0 + c);
+                        for (auto& x : cols[c]) {
+                            x *= u;
+                            u *= gInL;
+                        }
+                    });
+            }
+
+            if (inv) {
+                colFFT->batchiFFT(ptrs);
+            } else {
+                colFFT->batchFFT(ptrs);
+            }
+
+            Parallel::mapLambda(
+                width,
+                [&] (const std::size_t c) {
+                    const T w = omega ^ (l0 + c);
+                    T u = w;
+                    for (std::size_t k = 1; k < B; ++k) {
+                        cols[c][k] *= u;
+                        u *= w;
+                    }
+                });
+
+            for (std::size_t b = 0; b < B; ++b) {
+                for (std::size_t c = 0; c < width; ++c)
+                    run[c] = cols[c][b];
+
+                if (! writeRun(*files[b], b, l0, width, run.data())) return false;
+            }
+        }
+
+        return closeBlocks(files);
+    }
+
+    // FFTs of size blockSize, one block at a time
+    bool rowFFT(const bool inv) {
+        const LagrangeFFT<T> rowFFT(m_blockSize);
+
+        std::vector<T> row(m_blockSize);
+
+        BlockFiles files;
+        if (! openBlocks(files)) return false;
+
+        for (std::size_t b = 0; b < m_numBlocks; ++b) {
+            if (! readRun(*files[b], b, 0, m_blockSize, row.data())) return false;
+
+            if (inv) {
+                rowFFT->iFFT(row);
+            } else {
+                rowFFT->FFT(row);
+            }
+
+            if (! writeRun(*files[b], b, 0, m_blockSize, row.data())) return false;
+        }
+
+        return closeBlocks(files);
+    }
+
+    // element (k1, k2) is output k1 + numBlocks * k2, each output block
+    // is gathered from all blocks into a new file which then replaces
+    // the original
+    bool transposeBlocks(const T& gOut) {
+        const std::size_t
+            B = m_numBlocks,
+            L = m_blockSize,
+            width = L / B;
+
+        std::vector<T> runs(B * width);
+
+        BlockFiles files;
+        if (! openBlocks(files)) return false;
+
+        for (std::size_t block = 0; block < B; ++block) {
+            for (std::size_t b = 0; b < B; ++b) {
+                if (! readRun(*files[b], b, block * width, width, runs.data() + b * width))
+                    return false;
+            }
+
+            BlockVector<T> a(m_space, block);
+            auto& v = a.lvec();
+
+            Parallel::mapLambda(
+                width,
+                [&] (const std::size_t c) {
+                    for (std::size_t b = 0; b < B; ++b)
+                        v[c * B + b] = runs[b * width + c];
+
+                    if (T::one() != gOut) {
+                        T u = gOut ^ (block * L + c * B);
+                        for (std::size_t b = 0; b < B; ++b) {
+                            v[c * B + b] *= u;
+                            u *= gOut;
+                        }
+                    }
+                });
+
+            std::ofstream ofs(fileName(block) + ".tmp", std::ios::binary);
+            if (!ofs) return false;
+
+            a.marshal_out(
+                ofs,
+                [] (std::ostream& o, const T& x) { x.marshal_out_raw(o); });
+
+            if (!ofs) return false;
+        }
+
+        if (! closeBlocks(files)) return false;
+
+        for (std::size_t block = 0; block < B; ++block) {
+            const auto name = fileName(block);
+            if (std::rename((name + ".tmp").c_str(), name.c_str())) return false;
+        }
+
+        return true; // ok
+    }
+
+    const std::string m_filePrefix;
+    const IndexSpace<1> m_space;
+    const std::size_t m_numBlocks, m_blockSize, m_elementBytes;
+
+    // file position of the first element in each block
+    std::vector<std::size_t> m_offset;
+
+    // detect any errors in I/O
+    bool m_error;
+};
+
+} // namespace snarklib
+
+#endif
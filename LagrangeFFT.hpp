@@ -2,13 +2,20 @@
 #define _SNARKLIB_LAGRANGE_FFT_HPP_
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include <snarklib/Field.hpp>
 #include <snarklib/FpModel.hpp>
 #include <snarklib/FpX.hpp>
+#include <snarklib/Parallel.hpp>
 #include <snarklib/Util.hpp>
 
 namespace snarklib {
@@ -83,14 +90,56 @@ public:
             m_iFFT(a);
         }
 
+        // the multiplicative generator coset uses cached powers
         void cosetFFT(std::vector<T>& a, const T& g) const {
-            multiply_by_coset(a, g);
-            FFT(a);
+            batchCosetFFT({ &a }, g);
         }
 
         void icosetFFT(std::vector<T>& a, const T& g) const {
-            iFFT(a);
-            multiply_by_coset(a, inverse(g));
+            if (T::params.multiplicative_generator() == g) {
+#ifdef USE_ASSERT
+                assert(a.size() == min_size());
+#endif
+                m_icosetFFT(a, inverse_coset_powers());
+
+            } else {
+                iFFT(a);
+                multiply_by_coset(a, inverse(g));
+            }
+        }
+
+        // vectors of the same size transformed together, radix-2
+        // butterflies of all vectors share twiddle loads and threads
+        void batchFFT(const std::vector<std::vector<T>*>& a) const {
+#ifdef USE_ASSERT
+            for (const auto& v : a)
+                assert(v->size() == min_size());
+#endif
+            m_batchFFT(a);
+        }
+
+        void batchiFFT(const std::vector<std::vector<T>*>& a) const {
+#ifdef USE_ASSERT
+            for (const auto& v : a)
+                assert(v->size() == min_size());
+#endif
+            m_batchiFFT(a);
+        }
+
+        void batchCosetFFT(const std::vector<std::vector<T>*>& a, const T& g) const {
+            if (T::params.multiplicative_generator() == g) {
+#ifdef USE_ASSERT
+                for (const auto& v : a)
+                    assert(v->size() == min_size());
+#endif
+                m_batchCosetFFT(a, coset_powers());
+
+            } else {
+                for (const auto& v : a)
+                    multiply_by_coset(*v, g);
+
+                batchFFT(a);
+            }
         }
 
         virtual std::vector<T> lagrange_coeffs(const T& t, bool& weakPoint) const = 0;
@@ -116,11 +165,49 @@ public:
             return m_min_size;
         }
 
+        // radix-2 FFTs of at least this size use the six-step algorithm
+        // (process wide, default is 2^20 elements which are larger than
+        // the last level cache)
+        static std::size_t sixStepSize() {
+            return sixStepCount();
+        }
+
+        static void sixStepSize(const std::size_t a) {
+            sixStepCount() = a;
+        }
+
     protected:
         virtual void m_FFT(std::vector<T>& a) const = 0;
         virtual void m_iFFT(std::vector<T>& a) const = 0;
         virtual void m_add_poly_Z(const T& coeff, std::vector<T>& H) const = 0;
 
+        // one at a time unless a domain does better
+        virtual void m_batchFFT(const std::vector<std::vector<T>*>& a) const {
+            for (const auto& v : a)
+                m_FFT(*v);
+        }
+
+        virtual void m_batchiFFT(const std::vector<std::vector<T>*>& a) const {
+            for (const auto& v : a)
+                m_iFFT(*v);
+        }
+
+        // coset scaling by powers is a separate pass unless a domain
+        // does better
+        virtual void m_batchCosetFFT(const std::vector<std::vector<T>*>& a,
+                                     const std::vector<T>& powers) const {
+            for (const auto& v : a)
+                multiply_by_powers(*v, powers);
+
+            m_batchFFT(a);
+        }
+
+        virtual void m_icosetFFT(std::vector<T>& a,
+                                 const std::vector<T>& powers) const {
+            m_iFFT(a);
+            multiply_by_powers(a, powers);
+        }
+
         Base(const std::size_t min_size)
             : m_min_size(min_size)
         {}
@@ -132,56 +219,573 @@ public:
             assert(logn <= T::params.s());
 #endif
 
-            T omega = T::params.root_of_unity();
-            for (std::size_t i = T::params.s(); i > logn; --i) {
-                omega *= omega;
-            }
+            return rootsOfUnity()[logn];
+        }
 
-            return omega;
+        // powers of the multiplicative generator and its inverse, made
+        // the first time they are needed
+        const std::vector<T>& coset_powers() const {
+            std::call_once(
+                m_cosetOnce,
+                [this] {
+                    m_cosetPowers = power_table(T::params.multiplicative_generator(),
+                                                min_size());
+                });
+
+            return m_cosetPowers;
+        }
+
+        const std::vector<T>& inverse_coset_powers() const {
+            std::call_once(
+                m_inverseCosetOnce,
+                [this] {
+                    m_inverseCosetPowers = power_table(inverse(T::params.multiplicative_generator()),
+                                                       min_size());
+                });
+
+            return m_inverseCosetPowers;
         }
 
         T coset_shift() const {
             return squared(T::params.multiplicative_generator());
         }
 
-        void basic_radix2_FFT(std::vector<T>& a, const T& omega) const {
-            const std::size_t n = a.size();
+        // powers of omega for FFT of size n, the butterflies of each
+        // stage use every (n / 2m)-th element
+        static std::vector<T> twiddle_table(const T& omega, const std::size_t n) {
+            std::vector<T> w;
+            w.reserve(n / 2);
+
+            T w_i = T::one();
+            for (std::size_t i = 0; i < n / 2; ++i) {
+                w.emplace_back(w_i);
+                w_i *= omega;
+            }
+
+            return w;
+        }
+
+        // input is multiplied by scale (if not null) as it is reordered
+        void basic_radix2_FFT(std::vector<T>& a,
+                              const std::vector<T>& twiddle,
+                              const T* scale = nullptr) const {
+            basic_radix2_FFT(std::vector<std::vector<T>*>{ &a }, twiddle, scale);
+        }
+
+        void basic_radix2_FFT(const std::vector<std::vector<T>*>& a,
+                              const std::vector<T>& twiddle,
+                              const T* scale = nullptr) const {
+            if (a.empty()) return;
+
+            const std::size_t n = a[0]->size();
+#ifdef USE_ASSERT
+            assert(n == (1u << ceil_log2(n)));
+            assert(twiddle.size() == n / 2);
+#endif
+
+            // six-step needs at least two rows and columns
+            if (n >= 4 && n >= sixStepSize()) {
+                for (const auto& v : a)
+                    sixstep_FFT(*v, twiddle, scale);
+
+            } else {
+                std::vector<T*> A;
+                for (const auto& v : a)
+                    A.push_back(v->data());
+
+                radix2_FFT(A.data(), A.size(), n, twiddle.data(), 1, scale);
+            }
+        }
+
+        // in-place FFTs of size n for numVecs arrays in lockstep, twiddle
+        // W has every wstride-th power of the root of unity for size n,
+        // input element i is multiplied by scale[i] during bit reversal
+        static void radix2_FFT(T* const* A,
+                               const std::size_t numVecs,
+                               const std::size_t n,
+                               const T* W,
+                               const std::size_t wstride,
+                               const T* scale = nullptr) {
             const std::size_t logn = ceil_log2(n);
+
+            // sub-FFT blocks of 2^14 elements fit in cache, tasks are
+            // sized by the FFT and not the number of threads so results
+            // are the same for any number of threads
+            const std::size_t
+                blockSize = std::min(n, std::size_t(1) << 14),
+                numBlocks = n / blockSize;
+
+            // each swapped pair belongs to the task with its lower index
+            Parallel::mapLambda(
+                numBlocks,
+                [&] (const std::size_t block) {
+                    const std::size_t stop = (block + 1) * blockSize;
+
+                    for (std::size_t k = block * blockSize; k < stop; ++k) {
+                        const std::size_t rk = bit_reverse(k, logn);
+                        if (k < rk) {
+                            for (std::size_t v = 0; v < numVecs; ++v) {
+                                std::swap(A[v][k], A[v][rk]);
+
+                                if (scale) {
+                                    A[v][k] *= scale[rk];
+                                    A[v][rk] *= scale[k];
+                                }
+                            }
+
+                        } else if (scale && k == rk) {
+                            for (std::size_t v = 0; v < numVecs; ++v)
+                                A[v][k] *= scale[k];
+                        }
+                    }
+                });
+
+            // stages with butterfly groups inside one block, two stages
+            // at a time (radix-4) while possible
+            Parallel::mapLambda(
+                numBlocks,
+                [&] (const std::size_t block) {
+                    const std::size_t
+                        start = block * blockSize,
+                        stop = start + blockSize;
+
+                    std::size_t m = 1;
+
+                    for (; 4 * m <= blockSize; m *= 4) {
+                        const std::size_t stride = n / (4 * m) * wstride;
+
+                        for (std::size_t k = start; k < stop; k += 4*m)
+                            butterflies4(A, numVecs, k, m, 0, m, W, stride);
+                    }
+
+                    for (; m < blockSize; m *= 2) {
+                        const std::size_t stride = n / (2 * m) * wstride;
+
+                        for (std::size_t k = start; k < stop; k += 2*m)
+                            butterflies(A, numVecs, k, m, 0, m, W, stride);
+                    }
+                });
+
+            // remaining stages split butterfly groups into blocks
+            for (std::size_t m = blockSize; m < n; ) {
+                if (4 * m <= n) {
+                    const std::size_t stride = n / (4 * m) * wstride;
+
+                    // half a block of radix-4 butterflies in one group
+                    Parallel::mapLambda(
+                        numBlocks / 2,
+                        [&] (const std::size_t block) {
+                            const std::size_t
+                                first = block * blockSize / 2,
+                                k = (first / m) * 4 * m,
+                                j0 = first % m;
+
+                            butterflies4(A, numVecs, k, m, j0, j0 + blockSize / 2, W, stride);
+                        });
+
+                    m *= 4;
+
+                } else {
+                    const std::size_t stride = n / (2 * m) * wstride;
+
+                    // block of butterflies in one group
+                    Parallel::mapLambda(
+                        numBlocks / 2,
+                        [&] (const std::size_t block) {
+                            const std::size_t
+                                first = block * blockSize,
+                                k = (first / m) * 2 * m,
+                                j0 = first % m;
+
+                            butterflies(A, numVecs, k, m, j0, j0 + blockSize, W, stride);
+                        });
+
+                    m *= 2;
+                }
+            }
+        }
+
+        // six-step (Bailey) FFT for n = n1 * n2, a is viewed as n1 rows
+        // of n2 columns and only transforms of one row are in cache
+        static void sixstep_FFT(std::vector<T>& a,
+                                const std::vector<T>& twiddle,
+                                const T* scale = nullptr) {
+            const std::size_t
+                n = a.size(),
+                n1 = std::size_t(1) << (ceil_log2(n) / 2),
+                n2 = n / n1,
+                cols = std::min(n2, std::size_t(16)); // copied together share cache lines
+
 #ifdef USE_ASSERT
-            assert(n == (1u << logn));
+            assert(n1 > 1);
 #endif
 
-            for (std::size_t k = 0; k < n; ++k) {
-                const std::size_t rk = bit_reverse(k, logn);
-                if (k < rk)
-                    std::swap(a[k], a[rk]);
+            // twiddles for the smaller FFTs are kept together
+            std::vector<T> W1(n1 / 2), W2(n2 / 2);
+            for (std::size_t i = 0; i < n1 / 2; ++i) W1[i] = twiddle[i * n2];
+            for (std::size_t i = 0; i < n2 / 2; ++i) W2[i] = twiddle[i * n1];
+
+            // FFTs of size n1 down columns and twiddle by omega ^ (column * row)
+            Parallel::mapLambda(
+                n2 / cols,
+                [&] (const std::size_t colBlock) {
+                    std::vector<T> B(cols * n1);
+
+                    for (std::size_t j1 = 0; j1 < n1; ++j1) {
+                        for (std::size_t c = 0; c < cols; ++c)
+                            B[c * n1 + j1] = a[j1 * n2 + colBlock * cols + c];
+                    }
+
+                    if (scale) {
+                        for (std::size_t j1 = 0; j1 < n1; ++j1) {
+                            for (std::size_t c = 0; c < cols; ++c)
+                                B[c * n1 + j1] *= scale[j1 * n2 + colBlock * cols + c];
+                        }
+                    }
+
+                    for (std::size_t c = 0; c < cols; ++c) {
+                        const std::size_t j2 = colBlock * cols + c;
+                        T* const col = B.data() + c * n1;
+
+                        radix2_FFT(&col, 1, n1, W1.data(), 1);
+
+                        // j2 < n2 <= n / 2 and products are exact
+                        const T& w = twiddle[j2];
+                        T u = w;
+                        for (std::size_t k1 = 1; k1 < n1; ++k1) {
+                            col[k1] *= u;
+                            u *= w;
+                        }
+                    }
+
+                    for (std::size_t k1 = 0; k1 < n1; ++k1) {
+                        for (std::size_t c = 0; c < cols; ++c)
+                            a[k1 * n2 + colBlock * cols + c] = B[c * n1 + k1];
+                    }
+                });
+
+            // FFTs of size n2 along rows
+            Parallel::mapLambda(
+                n1,
+                [&] (const std::size_t k1) {
+                    T* const row = a.data() + k1 * n2;
+                    radix2_FFT(&row, 1, n2, W2.data(), 1);
+                });
+
+            // element (k1, k2) is output k1 + n1 * k2
+            transpose(a, n1, n2);
+        }
+
+        // in-place transpose of a (rows x cols) for cols equal to rows
+        // or 2 * rows, extra memory is one row
+        static void transpose(std::vector<T>& a,
+                              const std::size_t rows,
+                              const std::size_t cols) {
+#ifdef USE_ASSERT
+            assert(cols == rows || cols == 2 * rows);
+            assert(a.size() == rows * cols);
+#endif
+
+            if (cols == rows) {
+                transpose_square(a.data(), rows);
+                return;
             }
 
-            std::size_t m = 1;
-            for (std::size_t s = 1; s <= logn; ++s) {
-                const T w_m = omega ^ (n / (2 * m));
-
-                for (std::size_t k = 0; k < n; k += 2*m) {
-                    T w = T::one();
-                    for (std::size_t j = 0; j < m; ++j) {
-                        const T t = w * a[k + j + m];
-                        a[k + j + m] = a[k + j] - t;
-                        a[k + j] += t;
-                        w *= w_m;
+            // left halves of the rows followed by right halves is a
+            // permutation of blocks 2r + h to h * rows + r, moved one
+            // cycle at a time
+            std::vector<bool> moved(2 * rows, false);
+            std::vector<T> tmp(rows);
+
+            for (std::size_t start = 0; start < 2 * rows; ++start) {
+                if (moved[start]) continue;
+
+                std::copy(a.begin() + start * rows,
+                          a.begin() + (start + 1) * rows,
+                          tmp.begin());
+
+                std::size_t dst = start;
+                while (true) {
+                    moved[dst] = true;
+
+                    const std::size_t src = 2 * (dst % rows) + dst / rows;
+                    if (src == start) break;
+
+                    std::copy(a.begin() + src * rows,
+                              a.begin() + (src + 1) * rows,
+                              a.begin() + dst * rows);
+
+                    dst = src;
+                }
+
+                std::copy(tmp.begin(), tmp.end(), a.begin() + dst * rows);
+            }
+
+            // each half is a square
+            transpose_square(a.data(), rows);
+            transpose_square(a.data() + rows * rows, rows);
+        }
+
+        // in-place transpose of n x n square by swapping tiles of 32 x 32
+        // elements across the diagonal
+        static void transpose_square(T* a, const std::size_t n) {
+            const std::size_t tile = std::min(std::size_t(32), n);
+
+            Parallel::mapLambda(
+                n / tile,
+                [&] (const std::size_t rowTile) {
+                    const std::size_t r0 = rowTile * tile;
+
+                    // diagonal tile
+                    for (std::size_t r = r0; r < r0 + tile; ++r) {
+                        for (std::size_t c = r + 1; c < r0 + tile; ++c)
+                            std::swap(a[r * n + c], a[c * n + r]);
+                    }
+
+                    for (std::size_t c0 = r0 + tile; c0 < n; c0 += tile) {
+                        for (std::size_t r = r0; r < r0 + tile; ++r) {
+                            for (std::size_t c = c0; c < c0 + tile; ++c)
+                                std::swap(a[r * n + c], a[c * n + r]);
+                        }
                     }
+                });
+        }
+
+        static void butterfly(T& x, T& y, const T& w) {
+            const T t = w * y;
+            y = x - t;
+            x += t;
+        }
+
+        // y is already multiplied by the twiddle
+        static void butterfly(T& x, T& y) {
+            const T t = y;
+            y = x - t;
+            x += t;
+        }
+
+        // butterfly of elements i and i + m in each array
+        static void butterfly(T* const* A,
+                              const std::size_t numVecs,
+                              const std::size_t i,
+                              const std::size_t m,
+                              const T& w) {
+            for (std::size_t v = 0; v < numVecs; ++v)
+                butterfly(A[v][i], A[v][i + m], w);
+        }
+
+        // radix-2 stages m and 2m for elements i, i + m, i + 2m, i + 3m
+        // of each array which are loaded and stored once, stage 2m
+        // twiddles are every stride-th element of W
+        static void butterfly4(T* const* A,
+                               const std::size_t numVecs,
+                               const std::size_t i,
+                               const std::size_t m,
+                               const T* W,
+                               const std::size_t j,
+                               const std::size_t stride) {
+            const T
+                &w1 = W[2 * j * stride],
+                &w2 = W[j * stride],
+                &w3 = W[(j + m) * stride];
+
+            for (std::size_t v = 0; v < numVecs; ++v) {
+                T* const x = A[v] + i;
+
+                T
+                    x0 = x[0],
+                    x1 = x[m],
+                    x2 = x[2 * m],
+                    x3 = x[3 * m];
+
+                // stage m
+                butterfly(x0, x1, w1);
+                butterfly(x2, x3, w1);
+
+                // stage 2m
+                butterfly(x0, x2, w2);
+                butterfly(x1, x3, w3);
+
+                x[0] = x0;
+                x[m] = x1;
+                x[2 * m] = x2;
+                x[3 * m] = x3;
+            }
+        }
+
+        // butterflies of elements k + j and k + j + m in each array for
+        // j0 <= j < j1, twiddles are every stride-th element of W and
+        // wide groups multiply them as arrays in chunks that stay in cache
+        static void butterflies(T* const* A,
+                                const std::size_t numVecs,
+                                const std::size_t k,
+                                const std::size_t m,
+                                const std::size_t j0,
+                                const std::size_t j1,
+                                const T* W,
+                                const std::size_t stride) {
+            if (m < 8) {
+                for (std::size_t j = j0; j < j1; ++j)
+                    butterfly(A, numVecs, k + j, m, W[j * stride]);
+
+                return;
+            }
+
+            for (std::size_t j = j0; j < j1; j += 64) {
+                const std::size_t len = std::min(j1 - j, std::size_t(64));
+
+                for (std::size_t v = 0; v < numVecs; ++v) {
+                    T* const x = A[v] + k + j;
+
+                    mul_array(x + m, W + j * stride, len, 1, stride);
+
+                    for (std::size_t i = 0; i < len; ++i)
+                        butterfly(x[i], x[i + m]);
                 }
+            }
+        }
 
-                m *= 2;
+        // radix-2 stages m and 2m for j0 <= j < j1 as in butterfly4()
+        static void butterflies4(T* const* A,
+                                 const std::size_t numVecs,
+                                 const std::size_t k,
+                                 const std::size_t m,
+                                 const std::size_t j0,
+                                 const std::size_t j1,
+                                 const T* W,
+                                 const std::size_t stride) {
+            if (m < 8) {
+                for (std::size_t j = j0; j < j1; ++j)
+                    butterfly4(A, numVecs, k + j, m, W, j, stride);
+
+                return;
+            }
+
+            for (std::size_t j = j0; j < j1; j += 64) {
+                const std::size_t len = std::min(j1 - j, std::size_t(64));
+
+                for (std::size_t v = 0; v < numVecs; ++v) {
+                    T* const x = A[v] + k + j;
+
+                    // stage m
+                    mul_array(x + m, W + 2 * j * stride, len, 1, 2 * stride);
+                    mul_array(x + 3 * m, W + 2 * j * stride, len, 1, 2 * stride);
+
+                    for (std::size_t i = 0; i < len; ++i) {
+                        butterfly(x[i], x[i + m]);
+                        butterfly(x[i + 2 * m], x[i + 3 * m]);
+                    }
+
+                    // stage 2m
+                    mul_array(x + 2 * m, W + j * stride, len, 1, stride);
+                    mul_array(x + 3 * m, W + (j + m) * stride, len, 1, stride);
+
+                    for (std::size_t i = 0; i < len; ++i) {
+                        butterfly(x[i], x[i + 2 * m]);
+                        butterfly(x[i + m], x[i + 3 * m]);
+                    }
+                }
             }
         }
 
         void multiply_by_coset(std::vector<T>& a, const T& g) const {
-            T u = g;
+            const std::size_t
+                blockSize = std::size_t(1) << 14,
+                numBlocks = (a.size() + blockSize - 1) / blockSize;
+
+            // each block starts from its own power of g
+            Parallel::mapLambda(
+                numBlocks,
+                [&] (const std::size_t block) {
+                    const std::size_t
+                        start = std::max(std::size_t(1), block * blockSize),
+                        stop = std::min(a.size(), (block + 1) * blockSize);
+
+                    T u = g ^ start;
+
+                    for (std::size_t i = start; i < stop; ++i) {
+                        a[i] *= u;
+                        u *= g;
+                    }
+                });
+        }
 
-            for (std::size_t i = 1; i < a.size(); ++i) {
-                a[i] *= u;
-                u *= g;
-            }
+        // a[i] *= c * powers[i]
+        void multiply_by_powers(std::vector<T>& a,
+                                const std::vector<T>& powers,
+                                const T& c = T::one()) const {
+#ifdef USE_ASSERT
+            assert(a.size() <= powers.size());
+#endif
+
+            const std::size_t
+                blockSize = std::size_t(1) << 14,
+                numBlocks = (a.size() + blockSize - 1) / blockSize;
+
+            const bool scaled = (T::one() != c);
+
+            Parallel::mapLambda(
+                numBlocks,
+                [&] (const std::size_t block) {
+                    const std::size_t
+                        start = block * blockSize,
+                        len = std::min(a.size(), start + blockSize) - start;
+
+                    if (scaled)
+                        mul_array(a.data() + start, &c, len, 1, 0);
+
+                    mul_array(a.data() + start, powers.data() + start, len);
+                });
+        }
+
+        // func(start, stop) for blocks of [0, n), blocks run in parallel
+        template <typename FUNC>
+        static void map_blocks(const std::size_t n, FUNC func) {
+            const std::size_t
+                blockSize = std::size_t(1) << 14,
+                numBlocks = (n + blockSize - 1) / blockSize;
+
+            Parallel::mapLambda(
+                numBlocks,
+                [&] (const std::size_t block) {
+                    func(block * blockSize, std::min(n, (block + 1) * blockSize));
+                });
+        }
+
+        // a[i] *= c for i < n
+        static void scale(T* a, const std::size_t n, const T& c) {
+            map_blocks(
+                n,
+                [&] (const std::size_t start, const std::size_t stop) {
+                    mul_array(a + start, &c, stop - start, 1, 0);
+                });
+        }
+
+        // g ^ i for i < n
+        static std::vector<T> power_table(const T& g, const std::size_t n) {
+            std::vector<T> a(n);
+
+            const std::size_t
+                blockSize = std::size_t(1) << 14,
+                numBlocks = (n + blockSize - 1) / blockSize;
+
+            // each block starts from its own power of g
+            Parallel::mapLambda(
+                numBlocks,
+                [&] (const std::size_t block) {
+                    const std::size_t
+                        start = block * blockSize,
+                        stop = std::min(n, (block + 1) * blockSize);
+
+                    T u = g ^ start;
+
+                    for (std::size_t i = start; i < stop; ++i) {
+                        a[i] = u;
+                        u *= g;
+                    }
+                });
+
+            return a;
         }
 
         std::vector<T> basic_radix2_lagrange_coeffs(const std::size_t m,
@@ -214,35 +818,64 @@ public:
                 }
             }
 
+            // denominators t - omega ^ i are inverted together
+            T r = T::one();
+            for (std::size_t i = 0; i < m; ++i) {
+                u[i] = t - r;
+                r *= omega;
+            }
+
+            batch_invert_parallel(u);
+
             const T Z = (t ^ m) - T::one();
             T l = Z * inverse(T(m));
-            T r = T::one();
 
             for (std::size_t i = 0; i < m; ++i) {
-                u[i] = l * inverse(t - r);
+                u[i] *= l;
                 l *= omega;
-                r *= omega;
             }
 
             return u;
         }
 
     private:
+        // element i is the primitive root of unity of order 2^i, squared
+        // down from the field parameter once per process
+        static const std::vector<T>& rootsOfUnity() {
+            static const std::vector<T> a = [] {
+                std::vector<T> v(T::params.s() + 1);
+
+                v[T::params.s()] = T::params.root_of_unity();
+                for (std::size_t i = T::params.s(); i > 0; --i) {
+                    v[i - 1] = squared(v[i]);
+                }
+
+                return v;
+            }();
+
+            return a;
+        }
+
+        static std::atomic<std::size_t>& sixStepCount() {
+            static std::atomic<std::size_t> a(std::size_t(1) << 20);
+            return a;
+        }
+
         const std::size_t m_min_size;
+
+        // coset powers are made on demand by whichever thread is first
+        mutable std::once_flag m_cosetOnce, m_inverseCosetOnce;
+        mutable std::vector<T> m_cosetPowers, m_inverseCosetPowers;
     }; // class Base
 
+    // domains are shared, every LagrangeFFT of the same size in the
+    // process uses the same immutable domain
     LagrangeFFT(const std::size_t min_size)
-        : m_domain(
-            static_cast<LagrangeFFT<T>::Base*>(
-                get_evaluation_domain<T>(min_size)))
+        : m_domain(sharedDomain(min_size))
     {}
 
-    ~LagrangeFFT() {
-        delete m_domain;
-    }
-
     const Base* operator-> () const {
-        return m_domain;
+        return m_domain.get();
     }
 
     const Base& operator* () const {
@@ -271,8 +904,81 @@ public:
         }
     }
 
+    // release cached domains, those still in use remain until the
+    // last LagrangeFFT referring to them is gone
+    static void clearCache() {
+        auto& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        c.domains.clear();
+        c.recent.clear();
+    }
+
+    // domain of this size is in the cache
+    static bool isCached(const std::size_t min_size) {
+        auto& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        return c.domains.count(min_size);
+    }
+
+    // most recently used domains kept after the last LagrangeFFT using
+    // them is gone (process wide, default is 8 domains)
+    static std::size_t cacheSize() {
+        auto& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        return c.maxDomains;
+    }
+
+    static void cacheSize(const std::size_t a) {
+        auto& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        c.maxDomains = a;
+        evict(c);
+    }
+
 private:
-    const Base* m_domain;
+    struct DomainCache
+    {
+        std::mutex mutex;
+        std::size_t maxDomains = 8;
+        std::map<std::size_t, std::shared_ptr<const Base>> domains;
+        std::list<std::size_t> recent; // most recently used first
+    };
+
+    static DomainCache& cache() {
+        static DomainCache a;
+        return a;
+    }
+
+    // least recently used domains beyond the cache size
+    static void evict(DomainCache& c) {
+        while (c.recent.size() > c.maxDomains) {
+            c.domains.erase(c.recent.back());
+            c.recent.pop_back();
+        }
+    }
+
+    // domain is made once, other threads wait for it
+    static std::shared_ptr<const Base> sharedDomain(const std::size_t min_size) {
+        auto& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+
+        auto& p = c.domains[min_size];
+        if (p) {
+            c.recent.remove(min_size);
+        } else {
+            p.reset(static_cast<const Base*>(get_evaluation_domain<T>(min_size)));
+        }
+
+        c.recent.push_front(min_size);
+
+        // p may be evicted from the cache
+        const auto domain = p;
+        evict(c);
+
+        return domain;
+    }
+
+    std::shared_ptr<const Base> m_domain;
 };
 
 } // namespace snarklib
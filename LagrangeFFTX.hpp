@@ -17,7 +17,9 @@ class basic_radix2_domain : public LagrangeFFT<T>::Base
 public:
     basic_radix2_domain(const std::size_t min_size)
         : BASE(min_size),
-          omega(BASE::get_root_of_unity(min_size))
+          omega(BASE::get_root_of_unity(min_size)),
+          twiddle(BASE::twiddle_table(omega, min_size)),
+          inverse_twiddle(BASE::twiddle_table(inverse(omega), min_size))
     {
 #ifdef USE_ASSERT
         assert(min_size > 1);
@@ -43,23 +45,17 @@ public:
     void divide_by_Z_on_coset(std::vector<T>& P) const {
         const T coset = T::params.multiplicative_generator();
         const T Z_inverse_at_coset = inverse(compute_Z(coset));
-        for (std::size_t i = 0; i < BASE::min_size(); ++i) {
-            P[i] *= Z_inverse_at_coset;
-        }
+        BASE::scale(P.data(), BASE::min_size(), Z_inverse_at_coset);
     }
 
 protected:
     void m_FFT(std::vector<T>& a) const {
-        BASE::basic_radix2_FFT(a, omega);
+        BASE::basic_radix2_FFT(a, twiddle);
     }
 
     void m_iFFT(std::vector<T>& a) const {
-        BASE::basic_radix2_FFT(a, inverse(omega));
-
-        const T sconst = inverse(T(a.size()));
-        for (std::size_t i = 0; i < a.size(); ++i) {
-            a[i] *= sconst;
-        }
+        BASE::basic_radix2_FFT(a, inverse_twiddle);
+        BASE::scale(a.data(), a.size(), inverse(T(a.size())));
     }
 
     void m_add_poly_Z(const T& coeff, std::vector<T>& H) const {
@@ -67,8 +63,35 @@ protected:
         H[0] -= coeff;
     }
 
+    void m_batchFFT(const std::vector<std::vector<T>*>& a) const {
+        BASE::basic_radix2_FFT(a, twiddle);
+    }
+
+    void m_batchiFFT(const std::vector<std::vector<T>*>& a) const {
+        BASE::basic_radix2_FFT(a, inverse_twiddle);
+
+        const T sconst = inverse(T(BASE::min_size()));
+        for (const auto& v : a)
+            BASE::scale(v->data(), v->size(), sconst);
+    }
+
+    // coset scaling during bit reversal
+    void m_batchCosetFFT(const std::vector<std::vector<T>*>& a,
+                         const std::vector<T>& powers) const {
+        BASE::basic_radix2_FFT(a, twiddle, powers.data());
+    }
+
+    // coset and 1 / n scaling in one pass
+    void m_icosetFFT(std::vector<T>& a, const std::vector<T>& powers) const {
+        BASE::basic_radix2_FFT(a, inverse_twiddle);
+        BASE::multiply_by_powers(a, powers, inverse(T(a.size())));
+    }
+
 private:
     const T omega;
+
+    // powers of omega and its inverse
+    const std::vector<T> twiddle, inverse_twiddle;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -85,7 +108,9 @@ public:
         : BASE(min_size),
           small_m(min_size / 2),
           omega(BASE::get_root_of_unity(small_m)),
-          shift(BASE::coset_shift())
+          shift(BASE::coset_shift()),
+          twiddle(BASE::twiddle_table(omega, small_m)),
+          inverse_twiddle(BASE::twiddle_table(inverse(omega), small_m))
     {
 #ifdef USE_ASSERT
         assert(min_size > 1);
@@ -149,10 +174,8 @@ public:
             Z0_inverse = inverse(Z0),
             Z1_inverse = inverse(Z1);
 
-        for (std::size_t i = 0; i < small_m; ++i) {
-            P[i] *= Z0_inverse;
-            P[i + small_m] *= Z1_inverse;
-        }
+        BASE::scale(P.data(), small_m, Z0_inverse);
+        BASE::scale(P.data() + small_m, small_m, Z1_inverse);
     }
 
 protected:
@@ -163,16 +186,21 @@ protected:
 
         const T shift_to_small_m = shift ^ small_m;
 
-        T shift_i = T::one();
-        for (std::size_t i = 0; i < small_m; ++i) {
-            a0[i] = a[i] + a[small_m + i];
-            a1[i] = shift_i * (a[i] + shift_to_small_m * a[small_m + i]);
+        // each block starts from its own power of shift
+        BASE::map_blocks(
+            small_m,
+            [&] (const std::size_t start, const std::size_t stop) {
+                T shift_i = shift ^ start;
+                for (std::size_t i = start; i < stop; ++i) {
+                    a0[i] = a[i] + a[small_m + i];
+                    a1[i] = shift_i * (a[i] + shift_to_small_m * a[small_m + i]);
 
-            shift_i *= shift;
-        }
+                    shift_i *= shift;
+                }
+            });
 
-        BASE::basic_radix2_FFT(a0, omega);
-        BASE::basic_radix2_FFT(a1, omega);
+        BASE::basic_radix2_FFT(a0, twiddle);
+        BASE::basic_radix2_FFT(a1, twiddle);
 
         for (std::size_t i = 0; i < small_m; ++i) {
             a[i] = a0[i];
@@ -185,22 +213,26 @@ protected:
             a0(a.begin(), a.begin() + small_m),
             a1(a.begin() + small_m, a.end());
 
-        const T omega_inverse = inverse(omega);
-        BASE::basic_radix2_FFT(a0, omega_inverse);
-        BASE::basic_radix2_FFT(a1, omega_inverse);
+        BASE::basic_radix2_FFT(a0, inverse_twiddle);
+        BASE::basic_radix2_FFT(a1, inverse_twiddle);
 
         const T shift_to_small_m = shift ^ small_m;
         const T sconst = inverse(T(small_m) * (T::one() - shift_to_small_m));
 
         const T shift_inverse = inverse(shift);
-        T shift_inverse_i = T::one();
 
-        for (std::size_t i = 0; i < small_m; ++i) {
-            a[i] = sconst * (-shift_to_small_m * a0[i] + shift_inverse_i * a1[i]);
-            a[i + small_m] = sconst * (a0[i] - shift_inverse_i * a1[i]);
-
-            shift_inverse_i *= shift_inverse;
-        }
+        // each block starts from its own power of shift inverse
+        BASE::map_blocks(
+            small_m,
+            [&] (const std::size_t start, const std::size_t stop) {
+                T shift_inverse_i = shift_inverse ^ start;
+                for (std::size_t i = start; i < stop; ++i) {
+                    a[i] = sconst * (-shift_to_small_m * a0[i] + shift_inverse_i * a1[i]);
+                    a[i + small_m] = sconst * (a0[i] - shift_inverse_i * a1[i]);
+
+                    shift_inverse_i *= shift_inverse;
+                }
+            });
     }
 
     void m_add_poly_Z(const T& coeff, std::vector<T>& H) const {
@@ -214,6 +246,9 @@ protected:
 private:
     const std::size_t small_m;
     const T omega, shift;
+
+    // powers of omega and its inverse
+    const std::vector<T> twiddle, inverse_twiddle;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -232,7 +267,11 @@ public:
           small_m(min_size - big_m),
           omega(BASE::get_root_of_unity(1u << ceil_log2(min_size))),
           big_omega(squared(omega)),
-          small_omega(BASE::get_root_of_unity(small_m))
+          small_omega(BASE::get_root_of_unity(small_m)),
+          big_twiddle(BASE::twiddle_table(big_omega, big_m)),
+          big_inverse_twiddle(BASE::twiddle_table(inverse(big_omega), big_m)),
+          small_twiddle(BASE::twiddle_table(small_omega, small_m)),
+          small_inverse_twiddle(BASE::twiddle_table(inverse(small_omega), small_m))
     {
 #ifdef USE_ASSERT
         assert(min_size > 1);
@@ -256,12 +295,24 @@ public:
             omega_to_small_m = omega ^ small_m,
             big_omega_to_small_m = big_omega ^ small_m;
 
+        // big_omega ^ small_m has order big_m / small_m so denominators
+        // repeat with that period
+        std::vector<T> denom(big_m / small_m);
         T elt = T::one();
-        for (std::size_t i = 0; i < big_m; ++i) {
-            result[i] = inner_big[i] * L0 * inverse(elt - omega_to_small_m);
+        for (auto& d : denom) {
+            d = elt - omega_to_small_m;
             elt *= big_omega_to_small_m;
         }
 
+        batch_invert(denom);
+
+        for (auto& d : denom)
+            d *= L0;
+
+        for (std::size_t i = 0; i < big_m; ++i) {
+            result[i] = inner_big[i] * denom[i % denom.size()];
+        }
+
         const T L1 = ((t ^ big_m) - T::one()) * inverse((omega ^ big_m) - T::one());
 
         for (std::size_t i = 0; i < small_m; ++i) {
@@ -290,108 +341,157 @@ public:
             omega_to_small_m_times_Z0 = (omega ^ small_m) * Z0,
             omega_to_2small_m = omega ^ (2 * small_m);
 
+        // omega ^ (2 * small_m) has order big_m / small_m so denominators
+        // repeat with that period
+        std::vector<T> denom(big_m / small_m);
         T elt = T::one();
-        for (std::size_t i = 0; i < big_m; ++i) {
-            P[i] *= inverse(coset_to_small_m_times_Z0 * elt - omega_to_small_m_times_Z0);
+        for (auto& d : denom) {
+            d = coset_to_small_m_times_Z0 * elt - omega_to_small_m_times_Z0;
             elt *= omega_to_2small_m;
         }
 
+        batch_invert(denom);
+
+        BASE::map_blocks(
+            big_m,
+            [&] (const std::size_t start, const std::size_t stop) {
+                for (std::size_t i = start; i < stop; ++i)
+                    P[i] *= denom[i % denom.size()];
+            });
+
         const T Z1 = (((coset * omega) ^ big_m) - T::one())
                    * (((coset * omega) ^ small_m) - (omega ^ small_m));
 
-        const T Z1_inverse = inverse(Z1);
-
-        for (std::size_t i = 0; i < small_m; ++i) {
-            P[big_m + i] *= Z1_inverse;
-        }
+        BASE::scale(P.data() + big_m, small_m, inverse(Z1));
     }
 
 protected:
     void m_FFT(std::vector<T>& a) const {
-        std::vector<T>
-            c(big_m, T::zero()),
-            d(big_m, T::zero());
+        m_batchFFT({ &a });
+    }
 
-        T omega_i = T::one();
-        for (std::size_t i = 0; i < big_m; ++i) {
-            if (i < small_m) {
-                c[i] = a[i] + a[i + big_m];
-                d[i] = omega_i * (a[i] - a[i + big_m]);
-            } else {
-                c[i] = a[i];
-                d[i] = omega_i * a[i];
-            }
+    void m_iFFT(std::vector<T>& a) const {
+        m_batchiFFT({ &a });
+    }
 
-            omega_i *= omega;
-        }
+    void m_batchFFT(const std::vector<std::vector<T>*>& vecs) const {
+        const std::size_t numVecs = vecs.size();
 
-        std::vector<T> e(small_m, T::zero());
+        std::vector<std::vector<T>>
+            cs(numVecs, std::vector<T>(big_m, T::zero())),
+            es(numVecs, std::vector<T>(small_m, T::zero()));
 
         const std::size_t compr = 1u << (ceil_log2(big_m) - ceil_log2(small_m));
-        for (std::size_t i = 0; i < small_m; ++i) {
-            for (std::size_t j = 0; j < compr; ++j)
-                e[i] += d[i + j * small_m];
-        }
 
-        BASE::basic_radix2_FFT(c, squared(omega));
-        BASE::basic_radix2_FFT(e, BASE::get_root_of_unity(small_m));
-
-        for (std::size_t i = 0; i < big_m; ++i) {
-            a[i] = c[i];
+        for (std::size_t v = 0; v < numVecs; ++v) {
+            const auto& a = *vecs[v];
+            auto& c = cs[v];
+            auto& e = es[v];
+
+            std::vector<T> d(big_m, T::zero());
+
+            // each block starts from its own power of omega
+            BASE::map_blocks(
+                big_m,
+                [&] (const std::size_t start, const std::size_t stop) {
+                    T omega_i = omega ^ start;
+                    for (std::size_t i = start; i < stop; ++i) {
+                        if (i < small_m) {
+                            c[i] = a[i] + a[i + big_m];
+                            d[i] = omega_i * (a[i] - a[i + big_m]);
+                        } else {
+                            c[i] = a[i];
+                            d[i] = omega_i * a[i];
+                        }
+
+                        omega_i *= omega;
+                    }
+                });
+
+            BASE::map_blocks(
+                small_m,
+                [&] (const std::size_t start, const std::size_t stop) {
+                    for (std::size_t i = start; i < stop; ++i) {
+                        for (std::size_t j = 0; j < compr; ++j)
+                            e[i] += d[i + j * small_m];
+                    }
+                });
         }
 
-        for (std::size_t i = 0; i < small_m; ++i) {
-            a[i + big_m] = e[i];
-        }
-    }
+        BASE::basic_radix2_FFT(pointers(cs), big_twiddle);
+        BASE::basic_radix2_FFT(pointers(es), small_twiddle);
 
-    void m_iFFT(std::vector<T>& a) const {
-        std::vector<T>
-            U0(a.begin(), a.begin() + big_m),
-            U1(a.begin() + big_m, a.end());
+        for (std::size_t v = 0; v < numVecs; ++v) {
+            auto& a = *vecs[v];
 
-        BASE::basic_radix2_FFT(U0, inverse(squared(omega)));
-        BASE::basic_radix2_FFT(U1, inverse(BASE::get_root_of_unity(small_m)));
+            for (std::size_t i = 0; i < big_m; ++i) {
+                a[i] = cs[v][i];
+            }
 
-        const T U0_size_inv = inverse(T(big_m));
-        for (std::size_t i = 0; i < big_m; ++i) {
-            U0[i] *= U0_size_inv;
+            for (std::size_t i = 0; i < small_m; ++i) {
+                a[i + big_m] = es[v][i];
+            }
         }
+    }
 
-        const T U1_size_inv = inverse(T(small_m));
-        for (std::size_t i = 0; i < small_m; ++i) {
-            U1[i] *= U1_size_inv;
-        }
+    void m_batchiFFT(const std::vector<std::vector<T>*>& vecs) const {
+        const std::size_t numVecs = vecs.size();
 
-        std::vector<T> tmp = U0;
-        T omega_i = T::one();
-        for (std::size_t i = 0; i < big_m; ++i) {
-            tmp[i] *= omega_i;
-            omega_i *= omega;
+        std::vector<std::vector<T>> U0s, U1s;
+        for (const auto& a : vecs) {
+            U0s.emplace_back(a->begin(), a->begin() + big_m);
+            U1s.emplace_back(a->begin() + big_m, a->end());
         }
 
-        for (std::size_t i = small_m; i < big_m; ++i) {
-            a[i] = U0[i];
-        }
+        BASE::basic_radix2_FFT(pointers(U0s), big_inverse_twiddle);
+        BASE::basic_radix2_FFT(pointers(U1s), small_inverse_twiddle);
 
-        const std::size_t compr = 1u << (ceil_log2(big_m) - ceil_log2(small_m));
-        for (std::size_t i = 0; i < small_m; ++i) {
-            for (std::size_t j = 1; j < compr; ++j) {
-                U1[i] -= tmp[i + j * small_m];
-            }
-        }
+        const T
+            U0_size_inv = inverse(T(big_m)),
+            U1_size_inv = inverse(T(small_m)),
+            omega_inv = inverse(omega),
+            over_two = inverse(T(2ul));
 
-        const T omega_inv = inverse(omega);
-        T omega_inv_i = T::one();
-        for (std::size_t i = 0; i < small_m; ++i) {
-            U1[i] *= omega_inv_i;
-            omega_inv_i *= omega_inv;
-        }
+        const std::size_t compr = 1u << (ceil_log2(big_m) - ceil_log2(small_m));
 
-        const T over_two = inverse(T(2ul));
-        for (std::size_t i = 0; i < small_m; ++i) {
-            a[i] = (U0[i] + U1[i]) * over_two;
-            a[big_m + i] = (U0[i] - U1[i]) * over_two;
+        for (std::size_t v = 0; v < numVecs; ++v) {
+            auto& a = *vecs[v];
+            auto& U0 = U0s[v];
+            auto& U1 = U1s[v];
+
+            BASE::scale(U0.data(), big_m, U0_size_inv);
+            BASE::scale(U1.data(), small_m, U1_size_inv);
+
+            // each block starts from its own power of omega
+            std::vector<T> tmp = U0;
+            BASE::map_blocks(
+                big_m,
+                [&] (const std::size_t start, const std::size_t stop) {
+                    T omega_i = omega ^ start;
+                    for (std::size_t i = start; i < stop; ++i) {
+                        tmp[i] *= omega_i;
+                        omega_i *= omega;
+                    }
+                });
+
+            std::copy(U0.begin() + small_m, U0.end(), a.begin() + small_m);
+
+            BASE::map_blocks(
+                small_m,
+                [&] (const std::size_t start, const std::size_t stop) {
+                    T omega_inv_i = omega_inv ^ start;
+                    for (std::size_t i = start; i < stop; ++i) {
+                        for (std::size_t j = 1; j < compr; ++j) {
+                            U1[i] -= tmp[i + j * small_m];
+                        }
+
+                        U1[i] *= omega_inv_i;
+                        omega_inv_i *= omega_inv;
+
+                        a[i] = (U0[i] + U1[i]) * over_two;
+                        a[big_m + i] = (U0[i] - U1[i]) * over_two;
+                    }
+                });
         }
     }
 
@@ -405,8 +505,21 @@ protected:
     }
 
 private:
+    static std::vector<std::vector<T>*> pointers(std::vector<std::vector<T>>& a) {
+        std::vector<std::vector<T>*> p;
+        for (auto& v : a)
+            p.push_back(&v);
+
+        return p;
+    }
+
     const std::size_t big_m, small_m;
     const T omega, big_omega, small_omega;
+
+    // powers of big and small omega and their inverses
+    const std::vector<T>
+        big_twiddle, big_inverse_twiddle,
+        small_twiddle, small_inverse_twiddle;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2,13 +2,17 @@
 #define _SNARKLIB_MULTI_EXP_HPP_
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdint>
+#include <cstdlib>
 #include <gmp.h>
+#include <unordered_map>
 #include <vector>
 
 #include <snarklib/AuxSTL.hpp>
 #include <snarklib/BigInt.hpp>
+#include <snarklib/Parallel.hpp>
 #include <snarklib/ProgressCallback.hpp>
 
 namespace snarklib {
@@ -22,55 +26,42 @@ template <mp_size_t N, typename T>
 T wnafExp(const BigInt<N>& scalar,
           const T& base)
 {
-/* FIXME - this wNAF code requires intractably large amounts of memory
- *
- *                             BN128          Edwards
- *
- * How often used              50%            60%
- * minimum scalarBits          11             9
- * maximum scalarBits          198            177
- * (from 300 trials for each elliptic curve)
- *
- * The vector table of group elements will often be so large as to
- * exceed addressable memory. This causes the heap allocator to fail
- * and the process to abort. More intelligent algorithm memoization
- * is required.
- *
- * The code is left here (instead of removed) in case there are more
- * ideas which can fix its problems at a future time.
- *
+    // GLV endomorphism halves the doublings
+    T glvRes;
+    if (glvPower(scalar, base, glvRes)) return glvRes;
 
     const std::size_t scalarBits = scalar.numBits();
 
+    // window size w is one more than the largest table index i such
+    // that scalarBits >= wnaf_window_table()[i]
     for (long i = T::params.wnaf_window_table().size() - 1; i >= 0; --i) {
-        if (scalarBits >= T::params.wnaf_window_table()[i])
-        {
+        if (scalarBits >= T::params.wnaf_window_table()[i]) {
             const auto NAF = find_wNAF(i + 1, scalar);
 
-            // this table can be huge
-            std::vector<T> table(1u << (scalarBits - 1));
+            // odd multiples: base, 3 * base, ..., (2^w - 1) * base
+            std::vector<T> table(1u << i);
 
             auto tmp = base;
             const auto dbl = base.dbl();
-            for (std::size_t i = 0; i < table.size(); ++i) {
-                table[i] = tmp;
+            for (std::size_t j = 0; j < table.size(); ++j) {
+                table[j] = tmp;
                 tmp = tmp + dbl;
             }
 
             auto res = T::zero();
 
             bool found_nonzero = false;
-            for (long i = NAF.size() - 1; i >= 0; --i) {
+            for (long j = NAF.size() - 1; j >= 0; --j) {
                 if (found_nonzero) {
                     res = res.dbl();
                 }
 
-                if (NAF[i] != 0) {
+                if (NAF[j] != 0) {
                     found_nonzero = true;
-                    if (NAF[i] > 0) {
-                        res = res + table[NAF[i] / 2];
+                    if (NAF[j] > 0) {
+                        res = res + table[NAF[j] / 2];
                     } else {
-                        res = res - table[(-NAF[i]) / 2];
+                        res = res - table[(-NAF[j]) / 2];
                     }
                 }
             }
@@ -78,25 +69,442 @@ T wnafExp(const BigInt<N>& scalar,
             return res;
         }
     }
-*/
 
     return scalar * base;
 }
 
-// calculates sum(scalar[i] * base[i])
-template <typename T, typename F>
-T multiExp(const std::vector<T>& base,
-           const std::vector<F>& scalar,
-           ProgressCallback* callback = nullptr)
+// window size for bucket method, minimizes group operations:
+// (numWindows * (numTerms + 2 * numBuckets)) additions and numBits doublings
+template <typename T>
+std::size_t bucketWindowBits(const std::size_t numTerms,
+                             const std::size_t numBits,
+                             const std::size_t numSets = 1,
+                             const std::size_t numConcurrent = 1)
+{
+    std::size_t windowBits = 1, minCost = -1;
+
+    // buckets of all concurrent windows are limited to 64 MB
+    for (std::size_t c = 1;
+         c <= 20 && ((sizeof(T) * numSets * numConcurrent) << (c - 1)) <= (1ul << 26);
+         ++c)
+    {
+        const std::size_t
+            numWindows = numBits / c + 1,
+            cost = numWindows * (numTerms + (1ul << c)) + numBits;
+
+        if (cost < minCost) {
+            minCost = cost;
+            windowBits = c;
+        }
+    }
+
+    return windowBits;
+}
+
+// signed window digit of scalar, range is [-2^(c-1), 2^(c-1)] for c bits
+//
+// The carry in from the window below is its most significant bit. The
+// digits sum to the scalar as long as the most significant window has
+// a zero most significant bit.
+//
+template <mp_size_t N>
+long bucketDigit(const BigInt<N>& scalar,
+                 const std::size_t lowBit,
+                 const std::size_t windowBits)
+{
+    const std::size_t
+        part = lowBit / GMP_NUMB_BITS,
+        bit = lowBit % GMP_NUMB_BITS;
+
+    if (part >= N) return 0;
+
+    mp_limb_t x = scalar.data()[part] >> bit;
+
+    if (bit + windowBits > GMP_NUMB_BITS && part + 1 < N) {
+        x |= scalar.data()[part + 1] << (GMP_NUMB_BITS - bit);
+    }
+
+    long d = x & ((1ul << windowBits) - 1);
+
+    if (scalar.testBit(lowBit + windowBits - 1)) d -= (1l << windowBits);
+    if (lowBit && scalar.testBit(lowBit - 1)) ++d;
+
+    return d;
+}
+
+// sum(d * bucket[d - 1]) for one window of the bucket method with
+// numSets scalar vectors, digit(i) is the signed bucket number of term i
+//
+// Buckets 1, 2, ... numBuckets are for scalar vector 0, then numBuckets
+// more for scalar vector 1 and so on. A term for scalar vector s with
+// window digit d has bucket number sign(d) * (s * numBuckets + |d|).
+//
+template <typename T, typename BASE, typename DIGIT>
+std::vector<T> batchBucketWindow(const std::size_t numTerms,
+                                 const std::size_t numSets,
+                                 const BASE& base,
+                                 const DIGIT& digit,
+                                 const std::size_t windowBits)
+{
+    const std::size_t numBuckets = 1ul << (windowBits - 1);
+
+    // bucket for digit +/-d is at index d - 1
+    std::vector<T> bucket(numSets * numBuckets, T::zero());
+
+    for (std::size_t i = 0; i < numTerms; ++i) {
+        const long d = digit(i);
+
+        if (d) {
+            auto& b = bucket[std::labs(d) - 1];
+
+            // negation is cheap, mixed addition if base is special
+            const T a = (d > 0) ? base(i) : -base(i);
+            b = a.isSpecial()
+                ? fastAddSpecial(b, a)
+                : b + a;
+        }
+    }
+
+    // running sums
+    std::vector<T> windowSum(numSets, T::zero());
+    for (std::size_t s = 0; s < numSets; ++s) {
+        auto runSum = T::zero();
+        for (std::size_t d = numBuckets; d > 0; --d) {
+            runSum = runSum + bucket[s * numBuckets + d - 1];
+            windowSum[s] = windowSum[s] + runSum;
+        }
+    }
+
+    return windowSum;
+}
+
+// same as batchBucketWindow() when all base elements are special
+//
+// Buckets stay in special form. Additions to buckets are done in rounds
+// with affine arithmetic, batchAddSpecial() shares one field inversion
+// for the round. A bucket appears at most once in each round. If a base
+// element arrives for a bucket already in the round, it is added to a
+// bucket overflow with mixed addition instead.
+//
+template <typename T, typename BASE, typename DIGIT>
+std::vector<T> batchBucketWindowSpecial(const std::size_t numTerms,
+                                        const std::size_t numSets,
+                                        const BASE& base,
+                                        const DIGIT& digit,
+                                        const std::size_t windowBits)
+{
+    const std::size_t
+        numBuckets = 1ul << (windowBits - 1),
+        totalBuckets = numSets * numBuckets,
+        roundSize = std::min(1ul << 10, totalBuckets >> 3);
+
+    // inversion is not amortized well with few buckets
+    if (roundSize < 16) {
+        return batchBucketWindow<T>(numTerms, numSets, base, digit, windowBits);
+    }
+
+    // bucket for digit +/-d is at index d - 1
+    std::vector<T> bucket(totalBuckets, T::zero()), overflow;
+    std::vector<bool> inRound(totalBuckets, false);
+
+    std::vector<std::size_t> roundIdx;
+    std::vector<T> roundA, roundB;
+    roundIdx.reserve(roundSize);
+    roundA.reserve(roundSize);
+    roundB.reserve(roundSize);
+
+    const auto finishRound = [&] () {
+        batchAddSpecial(roundA, roundB);
+
+        for (std::size_t k = 0; k < roundIdx.size(); ++k) {
+            bucket[roundIdx[k]] = roundA[k];
+            inRound[roundIdx[k]] = false;
+        }
+
+        roundIdx.clear();
+        roundA.clear();
+        roundB.clear();
+    };
+
+    for (std::size_t i = 0; i < numTerms; ++i) {
+        const long d = digit(i);
+
+        if (! d) continue;
+
+        const std::size_t j = std::labs(d) - 1;
+        const T a = (d > 0) ? base(i) : -base(i);
+
+        if (inRound[j]) {
+            if (overflow.empty()) overflow.assign(totalBuckets, T::zero());
+            overflow[j] = fastAddSpecial(overflow[j], a);
+
+        } else if (bucket[j].isZero()) {
+            bucket[j] = a;
+
+        } else {
+            inRound[j] = true;
+            roundIdx.push_back(j);
+            roundA.emplace_back(bucket[j]);
+            roundB.emplace_back(a);
+
+            if (roundSize == roundIdx.size()) finishRound();
+        }
+    }
+
+    finishRound();
+
+    // running sums
+    std::vector<T> windowSum(numSets, T::zero());
+    for (std::size_t s = 0; s < numSets; ++s) {
+        auto runSum = T::zero();
+        for (std::size_t d = numBuckets; d > 0; --d) {
+            const std::size_t j = s * numBuckets + d - 1;
+
+            runSum = fastAddSpecial(runSum, bucket[j]);
+            if (! overflow.empty()) runSum = runSum + overflow[j];
+
+            windowSum[s] = windowSum[s] + runSum;
+        }
+    }
+
+    return windowSum;
+}
+
+// sum(d * bucket[d - 1]) for one window of the bucket method, digit(i)
+// is the window digit of term i
+template <typename T, typename BASE, typename DIGIT>
+T bucketWindow(const std::size_t numTerms,
+               const BASE& base,
+               const DIGIT& digit,
+               const std::size_t windowBits)
+{
+    return batchBucketWindow<T>(numTerms, 1, base, digit, windowBits)[0];
+}
+
+// same as bucketWindow() when all base elements are special
+template <typename T, typename BASE, typename DIGIT>
+T bucketWindowSpecial(const std::size_t numTerms,
+                      const BASE& base,
+                      const DIGIT& digit,
+                      const std::size_t windowBits)
+{
+    return batchBucketWindowSpecial<T>(numTerms, 1, base, digit, windowBits)[0];
+}
+
+// scalar out of Montgomery form, scalars already converted are unchanged
+template <typename F>
+BigInt<F::BaseType::numberLimbs()> scalarBigInt(const F& a)
+{
+    return a[0].asBigInt();
+}
+
+template <mp_size_t N>
+const BigInt<N>& scalarBigInt(const BigInt<N>& a)
+{
+    return a;
+}
+
+// threads left over from windows work on ranges of terms in the same
+// window, each range has many more terms than buckets
+inline std::size_t bucketRanges(const std::size_t numTerms,
+                                const std::size_t numWindows,
+                                const std::size_t numBuckets,
+                                const std::size_t numThreads)
+{
+    return std::max(1ul, std::min((numThreads + numWindows - 1) / numWindows,
+                                  numTerms / (4 * numBuckets)));
+}
+
+// converts scalars from Montgomery form, returns maximum number of bits
+template <typename F, typename SCALAR>
+std::size_t bucketScalars(const std::size_t numTerms,
+                          const SCALAR& scalar,
+                          std::vector<BigInt<F::BaseType::numberLimbs()>>& scalarVec)
+{
+    scalarVec.resize(numTerms);
+
+    const std::size_t chunkSize = 1u << 12;
+    std::vector<std::size_t> chunkBits((numTerms + chunkSize - 1) / chunkSize, 1);
+
+    Parallel::mapLambda(
+        chunkBits.size(),
+        [&] (const std::size_t j) {
+            const std::size_t stop = std::min(numTerms, (j + 1) * chunkSize);
+
+            for (std::size_t i = j * chunkSize; i < stop; ++i) {
+                scalarVec[i] = scalarBigInt(scalar(i));
+                chunkBits[j] = std::max(chunkBits[j], scalarVec[i].numBits());
+            }
+        });
+
+    return chunkBits.empty() ? 1 : *std::max_element(chunkBits.begin(), chunkBits.end());
+}
+
+// Pippenger bucket method for several scalar vectors with the same
+// bases, calculates sum(scalar(s, k) * base(k)) for each scalar vector s
+//
+// Terms of all scalar vectors share the buckets of a window, so each
+// base element is read once per window for the whole batch instead of
+// once per window for every scalar vector.
+//
+template <typename T, typename F, typename BASE, typename SCALAR>
+std::vector<T> batchBucketExp(const std::size_t numTerms,
+                              const std::size_t numSets,
+                              const BASE& base,
+                              const SCALAR& scalar,
+                              ProgressCallback* callback)
 {
     const std::size_t M = callback ? callback->minorSteps() : 0;
-    std::size_t progressCount = 0, callbackCount = 0;
+    std::size_t callbackCount = 0;
+
+    const mp_size_t N = F::BaseType::numberLimbs();
+
+    // convert from Montgomery form once, scalars are read every window
+    // (scalars for the same base element are next to each other)
+    std::vector<BigInt<N>> scalarVec;
+    const std::size_t numBits = bucketScalars<F>(
+        numTerms * numSets,
+        [&scalar, numSets] (const std::size_t i) -> decltype(scalar(0, 0)) {
+            return scalar(i % numSets, i / numSets);
+        },
+        scalarVec);
+
+    // extra window (if necessary) for carry out of most significant bit,
+    // buckets of windows running at the same time share the memory limit
+    const std::size_t
+        numThreads = Parallel::numThreads(),
+        windowBits = bucketWindowBits<T>(numTerms, numBits, numSets, numThreads),
+        numWindows = numBits / windowBits + 1,
+        numBuckets = 1ul << (windowBits - 1);
+
+    const std::size_t
+        numRanges = bucketRanges(numTerms, numWindows, numBuckets, numThreads),
+        rangeSize = (numTerms + numRanges - 1) / numRanges;
+
+    // proving key queries are special so batched affine addition works
+    bool allSpecial = true;
+    for (std::size_t i = 0; allSpecial && i < numTerms; ++i)
+        allSpecial = base(i).isSpecial();
+
+    std::vector<T> res(numSets, T::zero());
+
+    // most significant windows first, as many at once as threads
+    for (std::size_t w = numWindows; w > 0; ) {
+        const std::size_t roundSize = std::min(w, std::max(1ul, numThreads / numRanges));
+
+        std::vector<std::vector<T>> rangeSum(roundSize * numRanges);
+
+        Parallel::mapLambda(
+            rangeSum.size(),
+            [&] (const std::size_t task) {
+                const std::size_t
+                    k = task / numRanges,
+                    lowBit = (w - 1 - k) * windowBits,
+                    start = std::min(numTerms, (task % numRanges) * rangeSize) * numSets,
+                    stop = std::min(numTerms, (task % numRanges + 1) * rangeSize) * numSets;
+
+                const auto baseTerm = [&base, start, numSets] (const std::size_t i) -> decltype(base(0)) {
+                    return base((i + start) / numSets);
+                };
+
+                const auto digit = [&scalarVec, start, lowBit, windowBits, numSets, numBuckets] (const std::size_t i) {
+                    const long
+                        d = bucketDigit(scalarVec[i + start], lowBit, windowBits),
+                        offset = ((i + start) % numSets) * numBuckets;
+
+                    return (d > 0) ? d + offset : (d < 0) ? d - offset : 0;
+                };
 
+                rangeSum[task] = allSpecial
+                    ? batchBucketWindowSpecial<T>(stop - start, numSets, baseTerm, digit, windowBits)
+                    : batchBucketWindow<T>(stop - start, numSets, baseTerm, digit, windowBits);
+            });
+
+        // reduce windows in order, ranges of a window in task order
+        for (std::size_t k = 0; k < roundSize; ++k, --w) {
+            for (std::size_t s = 0; s < numSets; ++s) {
+                if (w < numWindows) {
+                    for (std::size_t j = 0; j < windowBits; ++j)
+                        res[s] = res[s].dbl();
+                }
+
+                for (std::size_t r = 0; r < numRanges; ++r)
+                    res[s] = res[s] + rangeSum[k * numRanges + r][s];
+            }
+        }
+
+        // one window is (1 / numWindows) of the work
+        while (callbackCount < M &&
+               callbackCount * numWindows < (numWindows - w) * M) {
+            ++callbackCount;
+            callback->minor();
+        }
+    }
+
+    // final callbacks
+    for (std::size_t i = callbackCount; i < M; ++i)
+        callback->minor();
+
+    // window sizes and ranges depend on the number of threads, special
+    // form is the same for any number of threads
+    batchSpecial(res);
+
+    return res;
+}
+
+// Pippenger bucket method, calculates sum(scalar(k) * base(k))
+//
+// Terms are views, base(k) and scalar(k) return references into the
+// caller's data for k = 0, 1, ... numTerms - 1. Nothing is copied.
+//
+template <typename T, typename F, typename BASE, typename SCALAR>
+T bucketExp(const std::size_t numTerms,
+            const BASE& base,
+            const SCALAR& scalar,
+            ProgressCallback* callback)
+{
+    return batchBucketExp<T, F>(
+        numTerms,
+        1,
+        base,
+        [&scalar] (const std::size_t, const std::size_t k) -> decltype(scalar(0)) {
+            return scalar(k);
+        },
+        callback)[0];
+}
+
+// Pippenger bucket method, calculates sum(scalar[i] * base[i])
+template <typename T, typename F>
+T bucketExp(const std::vector<T>& base,
+            const std::vector<F>& scalar,
+            ProgressCallback* callback = nullptr)
+{
 #ifdef USE_ASSERT
     assert(base.size() == scalar.size());
 #endif
 
-    if (base.empty()) {
+    return bucketExp<T, F>(
+        base.size(),
+        [&base] (const std::size_t k) -> const T& { return base[k]; },
+        [&scalar] (const std::size_t k) -> const F& { return scalar[k]; },
+        callback);
+}
+
+// Bos-Coster, calculates sum(scalar(k) * base(k)) with term views
+//
+// Reweighting changes bases. The input is not copied, a changed base
+// is kept only while its scalar is in the max-heap.
+//
+template <typename T, typename F, typename BASE, typename SCALAR>
+T bosCosterExp(const std::size_t numTerms,
+               const BASE& base,
+               const SCALAR& scalar,
+               ProgressCallback* callback)
+{
+    const std::size_t M = callback ? callback->minorSteps() : 0;
+    std::size_t progressCount = 0, callbackCount = 0;
+
+    if (0 == numTerms) {
         // final callbacks
         for (std::size_t i = callbackCount; i < M; ++i)
             callback->minor();
@@ -104,26 +512,32 @@ T multiExp(const std::vector<T>& base,
         return T::zero();
     }
 
-    if (1 == base.size()) {
+    if (1 == numTerms) {
         // final callbacks
         for (std::size_t i = callbackCount; i < M; ++i)
             callback->minor();
 
-        return scalar[0][0] * base[0];
+        return scalarBigInt(scalar(0)) * base(0);
     }
 
-    std::vector<T> baseVec(base);
-
     const mp_size_t N = F::BaseType::numberLimbs();
     typedef OrdPair<BigInt<N>, std::size_t> ScalarIndex;
 
-    PriorityQueue<ScalarIndex> scalarPQ(base.size());
+    PriorityQueue<ScalarIndex> scalarPQ(numTerms);
 
-    for (std::size_t i = 0; i < scalar.size(); ++i) {
+    for (std::size_t i = 0; i < numTerms; ++i) {
         scalarPQ.push(
-            ScalarIndex(scalar[i][0].asBigInt(), i));
+            ScalarIndex(scalarBigInt(scalar(i)), i));
     }
 
+    // reweighted bases by term index
+    std::unordered_map<std::size_t, T> reweighted;
+
+    const auto baseVec = [&base, &reweighted] (const std::size_t k) -> const T& {
+        const auto it = reweighted.find(k);
+        return (reweighted.end() == it) ? base(k) : it->second;
+    };
+
     auto res = T::zero();
 
     while (! scalarPQ.empty() &&
@@ -149,18 +563,22 @@ T multiExp(const std::vector<T>& base,
         if (reweight) {
             // xA + yB = xA - yA + yB + yA = (x - y)A + y(B + A)
             mpn_sub_n(a.key.data(), a.key.data(), b.key.data(), N);
-            baseVec[b.value] = baseVec[b.value] + baseVec[a.value];
+            const T sum = baseVec(b.value) + baseVec(a.value);
+            reweighted[b.value] = sum;
 
             scalarPQ.push(
                 ScalarIndex(a.key, a.value));
 
         } else {
-            res = res + wnafExp(a.key, baseVec[a.value]);
+            res = res + wnafExp(a.key, baseVec(a.value));
+
+            // term is finished
+            reweighted.erase(a.value);
         }
 
         // progress on the max-heap is difficult to estimate, use
         // heuristic of iteration over original size as one unit
-        if (callbackCount < M && (scalar.size() == ++progressCount)) {
+        if (callbackCount < M && (numTerms == ++progressCount)) {
             progressCount = 0;
             ++callbackCount;
             callback->minor();
@@ -174,6 +592,486 @@ T multiExp(const std::vector<T>& base,
     return res;
 }
 
+// Bos-Coster, calculates sum(scalar[i] * base[i])
+template <typename T, typename F>
+T bosCosterExp(const std::vector<T>& base,
+               const std::vector<F>& scalar,
+               ProgressCallback* callback = nullptr)
+{
+#ifdef USE_ASSERT
+    assert(base.size() == scalar.size());
+#endif
+
+    return bosCosterExp<T, F>(
+        base.size(),
+        [&base] (const std::size_t k) -> const T& { return base[k]; },
+        [&scalar] (const std::size_t k) -> const F& { return scalar[k]; },
+        callback);
+}
+
+// calculates sum(scalar(k) * base(k)) with term views
+template <typename T, typename F, typename BASE, typename SCALAR>
+T multiExp(const std::size_t numTerms,
+           const BASE& base,
+           const SCALAR& scalar,
+           ProgressCallback* callback)
+{
+    // Bos-Coster is faster for only a few terms
+    return (numTerms < 512)
+        ? bosCosterExp<T, F>(numTerms, base, scalar, callback)
+        : bucketExp<T, F>(numTerms, base, scalar, callback);
+}
+
+// calculates sum(scalar[i] * base[i])
+template <typename T, typename F>
+T multiExp(const std::vector<T>& base,
+           const std::vector<F>& scalar,
+           ProgressCallback* callback = nullptr)
+{
+#ifdef USE_ASSERT
+    assert(base.size() == scalar.size());
+#endif
+
+    return multiExp<T, F>(
+        base.size(),
+        [&base] (const std::size_t k) -> const T& { return base[k]; },
+        [&scalar] (const std::size_t k) -> const F& { return scalar[k]; },
+        callback);
+}
+
+// calculates sum(scalar(s, k) * base(k)) for numSets scalar vectors
+template <typename T, typename F, typename BASE, typename SCALAR>
+std::vector<T> batchMultiExp(const std::size_t numTerms,
+                             const std::size_t numSets,
+                             const BASE& base,
+                             const SCALAR& scalar,
+                             ProgressCallback* callback)
+{
+    std::vector<T> res;
+    res.reserve(numSets);
+
+    // Bos-Coster is faster for only a few terms, one scalar vector at a time
+    if (numTerms < 512) {
+        for (std::size_t s = 0; s < numSets; ++s) {
+            res.emplace_back(
+                bosCosterExp<T, F>(
+                    numTerms,
+                    base,
+                    [&scalar, s] (const std::size_t k) -> decltype(scalar(0, 0)) {
+                        return scalar(s, k);
+                    },
+                    (numSets - 1 == s) ? callback : nullptr));
+        }
+
+        return res;
+    }
+
+    // scalar vectors share buckets while the buckets of a window fit in
+    // about 2 MB, more misses cache on every bucket addition
+    const std::size_t
+        bucketBytes = sizeof(T) << (bucketWindowBits<T>(numTerms, F::sizeInBits()) - 1),
+        passSets = std::max(1ul, (1ul << 21) / bucketBytes);
+
+    for (std::size_t s = 0; s < numSets; s += passSets) {
+        const std::size_t n = std::min(passSets, numSets - s);
+
+        const auto pass = batchBucketExp<T, F>(
+            numTerms,
+            n,
+            base,
+            [&scalar, s] (const std::size_t j, const std::size_t k) -> decltype(scalar(0, 0)) {
+                return scalar(s + j, k);
+            },
+            (numSets == s + n) ? callback : nullptr);
+
+        res.insert(res.end(), pass.begin(), pass.end());
+    }
+
+    return res;
+}
+
+// calculates sum(scalar[s][i] * base[i]) for each scalar vector s
+template <typename T, typename F>
+std::vector<T> batchMultiExp(const std::vector<T>& base,
+                             const std::vector<const std::vector<F>*>& scalar,
+                             ProgressCallback* callback = nullptr)
+{
+#ifdef USE_ASSERT
+    for (const auto& a : scalar)
+        assert(base.size() == a->size());
+#endif
+
+    return batchMultiExp<T, F>(
+        base.size(),
+        scalar.size(),
+        [&base] (const std::size_t k) -> const T& { return base[k]; },
+        [&scalar] (const std::size_t s, const std::size_t k) -> const F& {
+            return (*scalar[s])[k];
+        },
+        callback);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// precomputed multiples of fixed bases
+//
+// Proving key queries are the same for every proof. Storing multiples
+// 2^(j * stepBits) * base[i] splits each scalar into depth pieces of
+// stepBits bits, so multi-exponentiation has fewer windows and doublings.
+// Memory is (depth - 1) times the bases.
+//
+
+template <typename T>
+class MultiExpTable
+{
+public:
+    MultiExpTable()
+        : m_depth(1),
+          m_stepBits(0)
+    {}
+
+    // base(i) returns the base at index i
+    template <typename BASE>
+    MultiExpTable(const std::size_t numBases,
+                  const BASE& base,
+                  const std::size_t depth,
+                  const std::size_t scalarBits)
+        : m_depth(std::max<std::size_t>(depth, 1)),
+          m_stepBits((scalarBits + m_depth) / m_depth),
+          m_multiple(numBases * (m_depth - 1))
+    {
+        if (1 == m_depth) return;
+
+        const std::size_t chunkSize = 1u << 12;
+
+        Parallel::mapLambda(
+            (numBases + chunkSize - 1) / chunkSize,
+            [&] (const std::size_t j) {
+                const std::size_t
+                    start = j * chunkSize,
+                    stop = std::min(numBases, start + chunkSize);
+
+                std::vector<T> vec;
+                vec.reserve((stop - start) * (m_depth - 1));
+
+                for (std::size_t i = start; i < stop; ++i) {
+                    auto a = base(i);
+
+                    for (std::size_t k = 1; k < m_depth; ++k) {
+                        for (std::size_t b = 0; b < m_stepBits; ++b)
+                            a = a.dbl();
+
+                        vec.emplace_back(a);
+                    }
+                }
+
+                // multiples are special like the bases
+                batchSpecial(vec);
+
+                std::copy(vec.begin(),
+                          vec.end(),
+                          m_multiple.begin() + start * (m_depth - 1));
+            });
+    }
+
+    MultiExpTable(const std::vector<T>& base,
+                  const std::size_t depth,
+                  const std::size_t scalarBits)
+        : MultiExpTable{base.size(),
+                        [&base] (const std::size_t i) -> const T& { return base[i]; },
+                        depth,
+                        scalarBits}
+    {}
+
+    std::size_t depth() const { return m_depth; }
+    std::size_t stepBits() const { return m_stepBits; }
+    bool empty() const { return m_multiple.empty(); }
+
+    // 2^(j * stepBits) * base(i) for 0 < j < depth
+    const T& operator() (const std::size_t i, const std::size_t j) const {
+        return m_multiple[i * (m_depth - 1) + j - 1];
+    }
+
+private:
+    std::size_t m_depth, m_stepBits;
+    std::vector<T> m_multiple;
+};
+
+// Pippenger bucket method with precomputed multiples of fixed bases,
+// calculates sum(scalar(k) * multiple(k, 0))
+//
+// The multiple(k, j) is 2^(j * stepBits) * base(k). Term k becomes pieces
+// of stepBits bits each with a multiple for base. Signed digits carry
+// from one piece to the next as in bucketDigit().
+//
+template <typename T, typename F, typename MULTIPLE, typename SCALAR>
+T fixedBaseExp(const std::size_t numTerms,
+               const std::size_t depth,
+               const std::size_t stepBits,
+               const MULTIPLE& multiple,
+               const SCALAR& scalar,
+               ProgressCallback* callback)
+{
+    const std::size_t M = callback ? callback->minorSteps() : 0;
+    std::size_t callbackCount = 0;
+
+    const mp_size_t N = F::BaseType::numberLimbs();
+
+    std::vector<BigInt<N>> scalarVec;
+    const std::size_t numBits = bucketScalars<F>(numTerms, scalar, scalarVec);
+
+    // most significant bit of top piece must be clear for the carry
+    const std::size_t pieces = std::min(depth, numBits / stepBits + 1);
+
+#ifdef USE_ASSERT
+    assert(numBits < pieces * stepBits);
+#endif
+
+    // buckets of windows running at the same time share the memory limit
+    const std::size_t
+        numThreads = Parallel::numThreads(),
+        totalTerms = numTerms * pieces,
+        windowBits = std::min(stepBits, bucketWindowBits<T>(totalTerms, stepBits, 1, numThreads)),
+        numWindows = (stepBits + windowBits - 1) / windowBits,
+        numBuckets = 1ul << (windowBits - 1);
+
+    // with a deep table there are only a few windows
+    const std::size_t
+        numRanges = bucketRanges(totalTerms, numWindows, numBuckets, numThreads),
+        rangeSize = (totalTerms + numRanges - 1) / numRanges;
+
+    // term i is piece (i % pieces) of scalar (i / pieces)
+    const auto base = [&multiple, pieces] (const std::size_t i) -> const T& {
+        return multiple(i / pieces, i % pieces);
+    };
+
+    bool allSpecial = true;
+    for (std::size_t i = 0; allSpecial && i < totalTerms; ++i)
+        allSpecial = base(i).isSpecial();
+
+    auto res = T::zero();
+
+    // most significant windows first, as many at once as threads
+    for (std::size_t w = numWindows; w > 0; ) {
+        const std::size_t roundSize = std::min(w, std::max(1ul, numThreads / numRanges));
+
+        std::vector<T> rangeSum(roundSize * numRanges);
+
+        Parallel::mapLambda(
+            rangeSum.size(),
+            [&] (const std::size_t task) {
+                // top window of each piece may be narrower
+                const std::size_t
+                    lowBit = (w - 1 - task / numRanges) * windowBits,
+                    bits = std::min(windowBits, stepBits - lowBit),
+                    start = std::min(totalTerms, (task % numRanges) * rangeSize),
+                    stop = std::min(totalTerms, (task % numRanges + 1) * rangeSize);
+
+                const auto rangeBase = [&base, start] (const std::size_t i) -> const T& {
+                    return base(i + start);
+                };
+
+                const auto digit = [&scalarVec, start, pieces, stepBits, lowBit, bits] (const std::size_t i) {
+                    return bucketDigit(scalarVec[(i + start) / pieces],
+                                       ((i + start) % pieces) * stepBits + lowBit,
+                                       bits);
+                };
+
+                rangeSum[task] = allSpecial
+                    ? bucketWindowSpecial<T>(stop - start, rangeBase, digit, bits)
+                    : bucketWindow<T>(stop - start, rangeBase, digit, bits);
+            });
+
+        // reduce windows in order, ranges of a window in task order
+        for (std::size_t k = 0; k < roundSize; ++k, --w) {
+            if (w < numWindows) {
+                for (std::size_t j = 0; j < windowBits; ++j)
+                    res = res.dbl();
+            }
+
+            for (std::size_t r = 0; r < numRanges; ++r)
+                res = res + rangeSum[k * numRanges + r];
+        }
+
+        // one window is (1 / numWindows) of the work
+        while (callbackCount < M &&
+               callbackCount * numWindows < (numWindows - w) * M) {
+            ++callbackCount;
+            callback->minor();
+        }
+    }
+
+    // final callbacks
+    for (std::size_t i = callbackCount; i < M; ++i)
+        callback->minor();
+
+    // window sizes and ranges depend on the number of threads, special
+    // form is the same for any number of threads
+    std::vector<T> v(1, res);
+    return batchSpecial(v)[0];
+}
+
+// calculates sum(scalar(k) * base(k)), index(k) is the table index of
+// base(k)
+template <typename T, typename F, typename BASE, typename INDEX, typename SCALAR>
+T multiExp(const std::size_t numTerms,
+           const BASE& base,
+           const INDEX& index,
+           const MultiExpTable<T>& table,
+           const SCALAR& scalar,
+           ProgressCallback* callback)
+{
+    // Bos-Coster is faster for only a few terms
+    if (table.empty() || numTerms < 512) {
+        return multiExp<T, F>(numTerms, base, scalar, callback);
+    }
+
+    return fixedBaseExp<T, F>(
+        numTerms,
+        table.depth(),
+        table.stepBits(),
+        [&base, &index, &table] (const std::size_t k, const std::size_t j) -> const T& {
+            return j ? table(index(k), j) : base(k);
+        },
+        scalar,
+        callback);
+}
+
+// calculates sum(scalar[i] * base[i]) with table of base multiples
+template <typename T, typename F>
+T multiExp(const std::vector<T>& base,
+           const std::vector<F>& scalar,
+           const MultiExpTable<T>& table,
+           ProgressCallback* callback = nullptr)
+{
+#ifdef USE_ASSERT
+    assert(base.size() == scalar.size());
+#endif
+
+    return multiExp<T, F>(
+        base.size(),
+        [&base] (const std::size_t k) -> const T& { return base[k]; },
+        [] (const std::size_t k) { return k; },
+        table,
+        [&scalar] (const std::size_t k) -> const F& { return scalar[k]; },
+        callback);
+}
+
+// sum over an index range, func(index, partialSum) accumulates terms
+// (chunks are the same for any number of threads so the sum is too)
+template <typename T, typename FUNC>
+T chunkSum(const std::size_t startIndex,
+           const std::size_t stopIndex,
+           FUNC func)
+{
+    const std::size_t
+        chunkSize = 1u << 12,
+        numChunks = (stopIndex > startIndex)
+            ? (stopIndex - startIndex + chunkSize - 1) / chunkSize
+            : 0;
+
+    std::vector<T> partialSum(numChunks, T::zero());
+
+    Parallel::mapLambda(
+        numChunks,
+        [&] (const std::size_t j) {
+            const std::size_t
+                start = startIndex + j * chunkSize,
+                stop = std::min(stopIndex, start + chunkSize);
+
+            for (std::size_t i = start; i < stop; ++i)
+                func(i, partialSum[j]);
+        });
+
+    auto res = T::zero();
+    for (const auto& a : partialSum)
+        res = res + a;
+
+    return res;
+}
+
+// short scalars are multi-exponentiated separately by bit length, they
+// need fewer windows and doublings: 8, 32, 64 bits or less, then the rest
+template <mp_size_t N>
+std::size_t scalarClass(const BigInt<N>& a)
+{
+    const std::size_t numBits = a.numBits();
+
+    return (numBits <= 8) ? 0
+        : (numBits <= 32) ? 1
+        : (numBits <= 64) ? 2
+        : 3;
+}
+
+// classes of scalar(i) for startIndex <= i < stopIndex, scalar(i) is
+// nullptr to skip term i, zeros and ones are skipped too
+//
+// Scalars are converted from Montgomery form once, in parallel. Terms
+// of class c are appended to index[c] and value[c] in index order.
+//
+template <typename F, typename SCALAR>
+void scalarClassIndex(const std::size_t startIndex,
+                      const std::size_t stopIndex,
+                      const SCALAR& scalar,
+                      std::array<std::vector<std::size_t>, 4>& index,
+                      std::array<std::vector<BigInt<F::BaseType::numberLimbs()>>, 4>& value)
+{
+    const auto
+        ZERO = F::zero(),
+        ONE = F::one();
+
+    const mp_size_t N = F::BaseType::numberLimbs();
+
+    const std::size_t
+        numTerms = (stopIndex > startIndex) ? stopIndex - startIndex : 0,
+        chunkSize = 1u << 12,
+        numChunks = (numTerms + chunkSize - 1) / chunkSize;
+
+    std::vector<std::array<std::vector<std::size_t>, 4>> chunkIndex(numChunks);
+    std::vector<std::array<std::vector<BigInt<N>>, 4>> chunkValue(numChunks);
+
+    Parallel::mapLambda(
+        numChunks,
+        [&] (const std::size_t j) {
+            const std::size_t stop = startIndex + std::min(numTerms, (j + 1) * chunkSize);
+
+            for (std::size_t i = startIndex + j * chunkSize; i < stop; ++i) {
+                const F* a = scalar(i);
+
+                if (a && ZERO != *a && ONE != *a) {
+                    const auto b = scalarBigInt(*a);
+                    const std::size_t c = scalarClass(b);
+
+                    chunkIndex[j][c].push_back(i);
+                    chunkValue[j][c].emplace_back(b);
+                }
+            }
+        });
+
+    for (std::size_t j = 0; j < numChunks; ++j) {
+        for (std::size_t c = 0; c < index.size(); ++c) {
+            index[c].insert(index[c].end(), chunkIndex[j][c].begin(), chunkIndex[j][c].end());
+            value[c].insert(value[c].end(), chunkValue[j][c].begin(), chunkValue[j][c].end());
+        }
+    }
+}
+
+// sum of multi-exponentiation over scalar classes, func(index, value,
+// callback) multi-exponentiates the terms in one class
+template <typename T, mp_size_t N, typename FUNC>
+T scalarClassExp(const std::array<std::vector<std::size_t>, 4>& index,
+                 const std::array<std::vector<BigInt<N>>, 4>& value,
+                 ProgressCallback* callback,
+                 FUNC func)
+{
+    auto res = T::zero();
+
+    // minor callbacks are for full size scalars, most of the work
+    for (std::size_t c = 0; c < index.size(); ++c)
+        res = res + func(index[c], value[c], (index.size() - 1 == c) ? callback : nullptr);
+
+    return res;
+}
+
 // sum of multi-exponentiation when scalar vector has many zeros and ones
 template <template <typename> class VEC, typename T, typename F>
 T multiExp01(const VEC<T>& base,
@@ -183,39 +1081,55 @@ T multiExp01(const VEC<T>& base,
              const std::size_t reserveCount, // for performance tuning
              ProgressCallback* callback)
 {
-    const auto
-        ZERO = F::zero(),
-        ONE = F::one();
+    const auto ONE = F::one();
 
-    std::vector<T> base2;
-    std::vector<F> scalar2;
+    const mp_size_t N = F::BaseType::numberLimbs();
+
+    // terms other than zero and one are multi-exponentiated in place
+    std::array<std::vector<std::size_t>, 4> index;
+    std::array<std::vector<BigInt<N>>, 4> value;
     if (reserveCount) {
-        base2.reserve(reserveCount);
-        scalar2.reserve(reserveCount);
+        index[3].reserve(reserveCount);
+        value[3].reserve(reserveCount);
     }
 
-    auto accum = T::zero();
-
-    for (std::size_t i = vector_start(base) + startOffset; i < vector_stop(base); ++i) {
-        const auto& a = scalar[i - indexShift];
-
-        if (ZERO == a) {
-            continue;
-
-        } else if (ONE == a) {
+    const auto accum = chunkSum<T>(
+        vector_start(base) + startOffset,
+        vector_stop(base),
+        [&] (const std::size_t i, T& partialSum) {
+            if (ONE == scalar[i - indexShift]) {
 #ifdef USE_ADD_SPECIAL
-            accum = fastAddSpecial(accum, base[i]);
+                partialSum = fastAddSpecial(partialSum, base[i]);
 #else
-            accum = accum + base[i];
+                partialSum = partialSum + base[i];
 #endif
+            }
+        });
 
-        } else {
-            base2.emplace_back(base[i]);
-            scalar2.emplace_back(a);
-        }
-    }
+    scalarClassIndex<F>(
+        vector_start(base) + startOffset,
+        vector_stop(base),
+        [&scalar, indexShift] (const std::size_t i) { return &scalar[i - indexShift]; },
+        index,
+        value);
 
-    return accum + multiExp(base2, scalar2, callback);
+    return accum + scalarClassExp<T>(
+        index,
+        value,
+        callback,
+        [&] (const std::vector<std::size_t>& idx,
+             const std::vector<BigInt<N>>& val,
+             ProgressCallback* cb) {
+            return multiExp<T, F>(
+                idx.size(),
+                [&base, &idx] (const std::size_t k) -> const T& {
+                    return base[idx[k]];
+                },
+                [&val] (const std::size_t k) -> const BigInt<N>& {
+                    return val[k];
+                },
+                cb);
+        });
 }
 
 // sum of multi-exponentiation when scalar vector has many zeros and ones
@@ -226,41 +1140,103 @@ T multiExp01(const std::vector<T>& base,     // VEC is std::vector
              const std::size_t indexShift,
              const std::vector<F>& scalar,
              const std::size_t reserveCount, // for performance tuning
-             ProgressCallback* callback)
+             ProgressCallback* callback,
+             const MultiExpTable<T>* table = nullptr)
 {
-    const auto
-        ZERO = F::zero(),
-        ONE = F::one();
+    const auto ONE = F::one();
+
+    const mp_size_t N = F::BaseType::numberLimbs();
 
-    std::vector<T> base2;
-    std::vector<F> scalar2;
+    // terms other than zero and one are multi-exponentiated in place
+    std::array<std::vector<std::size_t>, 4> index;
+    std::array<std::vector<BigInt<N>>, 4> value;
     if (reserveCount) {
-        base2.reserve(reserveCount);
-        scalar2.reserve(reserveCount);
+        index[3].reserve(reserveCount);
+        value[3].reserve(reserveCount);
     }
 
-    auto accum = T::zero();
-
-    for (std::size_t i = vector_start(base) + startOffset; i < vector_stop(base); ++i) {
-        const auto& a = scalar[i - indexShift];
-
-        if (ZERO == a) {
-            continue;
-
-        } else if (ONE == a) {
+    const auto accum = chunkSum<T>(
+        vector_start(base) + startOffset,
+        vector_stop(base),
+        [&] (const std::size_t i, T& partialSum) {
+            if (ONE == scalar[i - indexShift]) {
 #ifdef USE_ADD_SPECIAL
-            accum = fastAddSpecial(accum, base[i]);
+                partialSum = fastAddSpecial(partialSum, base[i]);
 #else
-            accum = accum + base[i];
+                partialSum = partialSum + base[i];
 #endif
+            }
+        });
 
-        } else {
-            base2.emplace_back(base[i]);
-            scalar2.emplace_back(a);
+    scalarClassIndex<F>(
+        vector_start(base) + startOffset,
+        vector_stop(base),
+        [&scalar, indexShift] (const std::size_t i) { return &scalar[i - indexShift]; },
+        index,
+        value);
+
+    return accum + scalarClassExp<T>(
+        index,
+        value,
+        callback,
+        [&] (const std::vector<std::size_t>& idx,
+             const std::vector<BigInt<N>>& val,
+             ProgressCallback* cb) {
+            const auto baseTerm = [&base, &idx] (const std::size_t k) -> const T& {
+                return base[idx[k]];
+            };
+
+            const auto scalarTerm = [&val] (const std::size_t k) -> const BigInt<N>& {
+                return val[k];
+            };
+
+            return table
+                ? multiExp<T, F>(idx.size(),
+                                 baseTerm,
+                                 [&idx] (const std::size_t k) { return idx[k]; },
+                                 *table,
+                                 scalarTerm,
+                                 cb)
+                : multiExp<T, F>(idx.size(), baseTerm, scalarTerm, cb);
+        });
+}
+
+// sums of multi-exponentiation for several scalar vectors with many
+// zeros and ones
+//
+// Only terms that are zero for every scalar vector are skipped. A one
+// costs a single bucket addition, the same as summing ones separately.
+//
+template <typename T, typename F>
+std::vector<T> batchMultiExp01(const std::vector<T>& base,
+                               const std::size_t startOffset,
+                               const std::size_t indexShift,
+                               const std::vector<const std::vector<F>*>& scalar,
+                               ProgressCallback* callback = nullptr)
+{
+    const auto ZERO = F::zero();
+
+    std::vector<std::size_t> index;
+
+    for (std::size_t i = startOffset; i < base.size(); ++i) {
+        for (const auto& a : scalar) {
+            if (ZERO != (*a)[i - indexShift]) {
+                index.push_back(i);
+                break;
+            }
         }
     }
 
-    return accum + multiExp(base2, scalar2, callback);
+    return batchMultiExp<T, F>(
+        index.size(),
+        scalar.size(),
+        [&base, &index] (const std::size_t k) -> const T& {
+            return base[index[k]];
+        },
+        [&scalar, &index, indexShift] (const std::size_t s, const std::size_t k) -> const F& {
+            return (*scalar[s])[index[k] - indexShift];
+        },
+        callback);
 }
 
 } // namespace snarklib
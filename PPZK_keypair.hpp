@@ -5,6 +5,7 @@
 #include <istream>
 #include <memory>
 #include <ostream>
+#include <string>
 
 #include <snarklib/AuxSTL.hpp>
 #include <snarklib/Group.hpp>
@@ -46,6 +47,19 @@ public:
                  const PPZK_LagrangePoint<Fr>& lagrangeRand,
                  const PPZK_BlindGreeks<Fr, Fr>& blindRand,
                  ProgressCallback* callback = nullptr)
+        : PPZK_Keypair{constraintSystem, numCircuitInputs, lagrangeRand,
+                       blindRand, std::string(), callback}
+    {}
+
+    // window tables are memory mapped from files in tableCacheDir and
+    // written there if missing (empty directory name means no cache)
+    template <template <typename> class SYS>
+    PPZK_Keypair(const SYS<Fr>& constraintSystem,
+                 const std::size_t numCircuitInputs,
+                 const PPZK_LagrangePoint<Fr>& lagrangeRand,
+                 const PPZK_BlindGreeks<Fr, Fr>& blindRand,
+                 const std::string& tableCacheDir,
+                 ProgressCallback* callback = nullptr)
     {
         ProgressCallback_NOP<PAIRING> dummyNOP;
         ProgressCallback* dummy = callback ? callback : std::addressof(dummyNOP);
@@ -81,11 +95,15 @@ public:
 
         // step 8 - G1 window table
         dummy->major(true);
-        const WindowExp<G1> g1_table(g1_exp_count(qap, ABCt, Ht), dummy);
+        const auto g1_table = tableCacheDir.empty()
+            ? WindowExp<G1>(g1_exp_count(qap, ABCt, Ht), dummy)
+            : WindowExp<G1>(g1_exp_count(qap, ABCt, Ht), tableCacheDir, dummy);
 
         // step 7 - G2 window table
         dummy->major(true);
-        const WindowExp<G2> g2_table(g2_exp_count(ABCt), dummy);
+        const auto g2_table = tableCacheDir.empty()
+            ? WindowExp<G2>(g2_exp_count(ABCt), dummy)
+            : WindowExp<G2>(g2_exp_count(ABCt), tableCacheDir, dummy);
 
         // step 6 - input consistency
         dummy->major(true);
@@ -3,12 +3,14 @@
 
 #include <functional>
 #include <istream>
+#include <memory>
 #include <ostream>
 #include <utility>
 #include <vector>
 
 #include <snarklib/AuxSTL.hpp>
 #include <snarklib/Group.hpp>
+#include <snarklib/MultiExp.hpp>
 #include <snarklib/Pairing.hpp>
 #include <snarklib/PPZK_query.hpp>
 
@@ -273,6 +275,57 @@ private:
     std::vector<G1> m_K_query;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// Precomputed proving key
+// Tables of query base multiples for circuits proved many times. Memory
+// is (depth - 1) times the proving key, which must outlive this object.
+//
+
+template <typename PAIRING>
+class PPZK_PrecomputedKey
+{
+    typedef typename PAIRING::Fr Fr;
+    typedef typename PAIRING::G1 G1;
+    typedef typename PAIRING::G2 G2;
+
+public:
+    PPZK_PrecomputedKey(const PPZK_ProvingKey<PAIRING>& pk,
+                        const std::size_t depth)
+        : m_pk(std::addressof(pk)),
+          m_A_table(sparseTable(pk.A_query(), depth)),
+          m_B_table(sparseTable(pk.B_query(), depth)),
+          m_C_table(sparseTable(pk.C_query(), depth)),
+          m_H_table(pk.H_query(), depth, Fr::sizeInBits()),
+          m_K_table(pk.K_query(), depth, Fr::sizeInBits())
+    {}
+
+    const PPZK_ProvingKey<PAIRING>& pk() const { return *m_pk; }
+
+    const MultiExpTable<Pairing<G1, G1>>& A_table() const { return m_A_table; }
+    const MultiExpTable<Pairing<G2, G1>>& B_table() const { return m_B_table; }
+    const MultiExpTable<Pairing<G1, G1>>& C_table() const { return m_C_table; }
+    const MultiExpTable<G1>& H_table() const { return m_H_table; }
+    const MultiExpTable<G1>& K_table() const { return m_K_table; }
+
+private:
+    template <typename T>
+    static MultiExpTable<T> sparseTable(const SparseVector<T>& query,
+                                        const std::size_t depth) {
+        return MultiExpTable<T>(
+            query.size(),
+            [&query] (const std::size_t i) -> const T& { return query.getElement(i); },
+            depth,
+            Fr::sizeInBits());
+    }
+
+    const PPZK_ProvingKey<PAIRING>* m_pk;
+    MultiExpTable<Pairing<G1, G1>> m_A_table;
+    MultiExpTable<Pairing<G2, G1>> m_B_table;
+    MultiExpTable<Pairing<G1, G1>> m_C_table;
+    MultiExpTable<G1> m_H_table;
+    MultiExpTable<G1> m_K_table;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Verification key
 //
@@ -1,10 +1,13 @@
 #ifndef _SNARKLIB_PPZK_PROOF_HPP_
 #define _SNARKLIB_PPZK_PROOF_HPP_
 
+#include <algorithm>
+#include <cassert>
 #include <cstdint>
 #include <istream>
 #include <memory>
 #include <ostream>
+#include <vector>
 
 #include <snarklib/AuxSTL.hpp>
 #include <snarklib/Pairing.hpp>
@@ -53,51 +56,8 @@ public:
                const std::size_t reserveTune,
                ProgressCallback* callback)
     {
-        ProgressCallback_NOP<PAIRING> dummyNOP;
-        ProgressCallback* dummy = callback ? callback : std::addressof(dummyNOP);
-        dummy->majorSteps(6);
-
-        // randomness
-        const auto
-            &d1 = proofRand.d1(),
-            &d2 = proofRand.d2(),
-            &d3 = proofRand.d3();
-
-        const QAP_SystemPoint<SYS, Fr> qap(constraintSystem, numCircuitInputs);
-
-        // step 6 - A
-        dummy->major(true);
-        PPZK_WitnessA<PAIRING> Aw(qap, witness, d1);
-        Aw.accumQuery(pk.A_query(), reserveTune, callback);
-        m_A = Aw.val();
-
-        // step 5 - B
-        dummy->major(true);
-        PPZK_WitnessB<PAIRING> Bw(qap, witness, d2);
-        Bw.accumQuery(pk.B_query(), reserveTune, callback);
-        m_B = Bw.val();
-
-        // step 4 - C
-        dummy->major(true);
-        PPZK_WitnessC<PAIRING> Cw(qap, witness, d3);
-        Cw.accumQuery(pk.C_query(), reserveTune, callback);
-        m_C = Cw.val();
-
-        // step 3 - ABCH
-        dummy->major(true);
-        const QAP_WitnessABCH<SYS, Fr> ABCH(qap, witness, d1, d2, d3, callback);
-
-        // step 2 - H
-        dummy->major(true);
-        PPZK_WitnessH<PAIRING> Hw;
-        Hw.accumQuery(pk.H_query(), ABCH.vec(), callback);
-        m_H = Hw.val();
-
-        // step 1 - K
-        dummy->major(true);
-        PPZK_WitnessK<PAIRING> Kw(witness, d1, d2, d3);
-        Kw.accumQuery(pk.K_query(), reserveTune, callback);
-        m_K = Kw.val();
+        prove(constraintSystem, numCircuitInputs, pk, nullptr,
+              witness, proofRand, reserveTune, callback);
     }
 
     template <template <typename> class SYS>
@@ -110,6 +70,30 @@ public:
         : PPZK_Proof{constraintSystem, numCircuitInputs, pk, witness, proofRand, 0, callback}
     {}
 
+    // precomputed proving key
+    template <template <typename> class SYS>
+    PPZK_Proof(const SYS<Fr>& constraintSystem,
+               const std::size_t numCircuitInputs,
+               const PPZK_PrecomputedKey<PAIRING>& ppk,
+               const R1Witness<Fr>& witness,
+               const PPZK_ProofRandomness<Fr>& proofRand,
+               const std::size_t reserveTune,
+               ProgressCallback* callback)
+    {
+        prove(constraintSystem, numCircuitInputs, ppk.pk(), std::addressof(ppk),
+              witness, proofRand, reserveTune, callback);
+    }
+
+    template <template <typename> class SYS>
+    PPZK_Proof(const SYS<Fr>& constraintSystem,
+               const std::size_t numCircuitInputs,
+               const PPZK_PrecomputedKey<PAIRING>& ppk,
+               const R1Witness<Fr>& witness,
+               const PPZK_ProofRandomness<Fr>& proofRand,
+               ProgressCallback* callback = nullptr)
+        : PPZK_Proof{constraintSystem, numCircuitInputs, ppk, witness, proofRand, 0, callback}
+    {}
+
     const Pairing<G1, G1>& A() const { return m_A; }
     const Pairing<G2, G1>& B() const { return m_B; }
     const Pairing<G1, G1>& C() const { return m_C; }
@@ -173,6 +157,71 @@ public:
     }
 
 private:
+    template <template <typename> class SYS>
+    void prove(const SYS<Fr>& constraintSystem,
+               const std::size_t numCircuitInputs,
+               const PPZK_ProvingKey<PAIRING>& pk,
+               const PPZK_PrecomputedKey<PAIRING>* ppk, // may be null
+               const R1Witness<Fr>& witness,
+               const PPZK_ProofRandomness<Fr>& proofRand,
+               const std::size_t reserveTune,
+               ProgressCallback* callback)
+    {
+        ProgressCallback_NOP<PAIRING> dummyNOP;
+        ProgressCallback* dummy = callback ? callback : std::addressof(dummyNOP);
+        dummy->majorSteps(6);
+
+        // randomness
+        const auto
+            &d1 = proofRand.d1(),
+            &d2 = proofRand.d2(),
+            &d3 = proofRand.d3();
+
+        const QAP_SystemPoint<SYS, Fr> qap(constraintSystem, numCircuitInputs);
+
+        // step 6 - A
+        dummy->major(true);
+        PPZK_WitnessA<PAIRING> Aw(qap, witness, d1);
+        Aw.accumQuery(pk.A_query(), reserveTune, callback,
+                      ppk ? std::addressof(ppk->A_table()) : nullptr);
+        m_A = Aw.val();
+
+        // step 5 - B
+        dummy->major(true);
+        PPZK_WitnessB<PAIRING> Bw(qap, witness, d2);
+        Bw.accumQuery(pk.B_query(), reserveTune, callback,
+                      ppk ? std::addressof(ppk->B_table()) : nullptr);
+        m_B = Bw.val();
+
+        // step 4 - C
+        dummy->major(true);
+        PPZK_WitnessC<PAIRING> Cw(qap, witness, d3);
+        Cw.accumQuery(pk.C_query(), reserveTune, callback,
+                      ppk ? std::addressof(ppk->C_table()) : nullptr);
+        m_C = Cw.val();
+
+        // step 3 - ABCH
+        dummy->major(true);
+        const QAP_WitnessABCH<SYS, Fr> ABCH(qap, witness, d1, d2, d3, callback);
+
+        // step 2 - H
+        dummy->major(true);
+        PPZK_WitnessH<PAIRING> Hw;
+        if (ppk) {
+            Hw.accumQuery(pk.H_query(), ABCH.vec(), ppk->H_table(), callback);
+        } else {
+            Hw.accumQuery(pk.H_query(), ABCH.vec(), callback);
+        }
+        m_H = Hw.val();
+
+        // step 1 - K
+        dummy->major(true);
+        PPZK_WitnessK<PAIRING> Kw(witness, d1, d2, d3);
+        Kw.accumQuery(pk.K_query(), reserveTune, callback,
+                      ppk ? std::addressof(ppk->K_table()) : nullptr);
+        m_K = Kw.val();
+    }
+
     Pairing<G1, G1> m_A;
     Pairing<G2, G1> m_B;
     Pairing<G1, G1> m_C;
@@ -180,6 +229,134 @@ private:
     G1 m_K;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// Proof generation for a batch of witnesses
+//
+// All witnesses satisfy the same constraint system. The QAP and its
+// evaluation domain are built once. Each proving key query is read once
+// for the whole batch by multi-exponentiation of all witnesses together.
+// The H query scalars (degree + 1 elements for each witness) are made
+// for chunkSize witnesses at a time, which bounds the memory used.
+//
+
+template <typename PAIRING>
+class PPZK_BatchProof
+{
+    typedef typename PAIRING::Fr Fr;
+    typedef typename PAIRING::G1 G1;
+    typedef typename PAIRING::G2 G2;
+
+public:
+    template <template <typename> class SYS>
+    PPZK_BatchProof(const SYS<Fr>& constraintSystem,
+                    const std::size_t numCircuitInputs,
+                    const PPZK_ProvingKey<PAIRING>& pk,
+                    const std::vector<R1Witness<Fr>>& witness,
+                    const std::vector<PPZK_ProofRandomness<Fr>>& proofRand,
+                    const std::size_t chunkSize,
+                    ProgressCallback* callback)
+    {
+#ifdef USE_ASSERT
+        assert(witness.size() == proofRand.size());
+#endif
+
+        ProgressCallback_NOP<PAIRING> dummyNOP;
+        ProgressCallback* dummy = callback ? callback : std::addressof(dummyNOP);
+        dummy->majorSteps(6);
+
+        const std::size_t
+            numSets = witness.size(),
+            chunk = chunkSize ? chunkSize : std::max<std::size_t>(numSets, 1);
+
+        std::vector<const std::vector<Fr>*> witnessVec;
+        std::vector<const Fr*> d1, d2, d3;
+        for (std::size_t s = 0; s < numSets; ++s) {
+            witnessVec.push_back(std::addressof(*witness[s]));
+            d1.push_back(std::addressof(proofRand[s].d1()));
+            d2.push_back(std::addressof(proofRand[s].d2()));
+            d3.push_back(std::addressof(proofRand[s].d3()));
+        }
+
+        const QAP_SystemPoint<SYS, Fr> qap(constraintSystem, numCircuitInputs);
+
+        // step 6 - A
+        dummy->major(true);
+        const auto A = PPZK_WitnessA<PAIRING>::batchQuery(
+            pk.A_query(), qap.numVariables(), witnessVec, d1, callback);
+
+        // step 5 - B
+        dummy->major(true);
+        const auto B = PPZK_WitnessB<PAIRING>::batchQuery(
+            pk.B_query(), qap.numVariables(), witnessVec, d2, callback);
+
+        // step 4 - C
+        dummy->major(true);
+        const auto C = PPZK_WitnessC<PAIRING>::batchQuery(
+            pk.C_query(), qap.numVariables(), witnessVec, d3, callback);
+
+        // step 3 - ABCH
+        dummy->major(true);
+        std::vector<G1> H;
+        H.reserve(numSets);
+
+        for (std::size_t s0 = 0; s0 < numSets; s0 += chunk) {
+            const std::size_t n = std::min(chunk, numSets - s0);
+
+            std::vector<std::vector<Fr>> ABCH;
+            ABCH.reserve(n);
+            for (std::size_t s = s0; s < s0 + n; ++s) {
+                // minor steps are counted for the first witness only
+                ABCH.emplace_back(
+                    QAP_WitnessABCH<SYS, Fr>(qap, witness[s], *d1[s], *d2[s], *d3[s],
+                                             s ? nullptr : callback).vec());
+            }
+
+            // step 2 - H, minor steps are counted for the last chunk only
+            if (0 == s0) dummy->major(true);
+
+            std::vector<const std::vector<Fr>*> ABCHVec;
+            for (const auto& a : ABCH)
+                ABCHVec.push_back(std::addressof(a));
+
+            const auto Hchunk = batchMultiExp(pk.H_query(), ABCHVec,
+                                              (numSets == s0 + n) ? callback : nullptr);
+
+            H.insert(H.end(), Hchunk.begin(), Hchunk.end());
+        }
+
+        // step 1 - K
+        dummy->major(true);
+        const auto K = PPZK_WitnessK<PAIRING>::batchQuery(
+            pk.K_query(), witnessVec, d1, d2, d3, callback);
+
+        m_proofs.reserve(numSets);
+        for (std::size_t s = 0; s < numSets; ++s)
+            m_proofs.emplace_back(A[s], B[s], C[s], H[s], K[s]);
+    }
+
+    // H query scalars of 16 witnesses at a time
+    template <template <typename> class SYS>
+    PPZK_BatchProof(const SYS<Fr>& constraintSystem,
+                    const std::size_t numCircuitInputs,
+                    const PPZK_ProvingKey<PAIRING>& pk,
+                    const std::vector<R1Witness<Fr>>& witness,
+                    const std::vector<PPZK_ProofRandomness<Fr>>& proofRand,
+                    ProgressCallback* callback = nullptr)
+        : PPZK_BatchProof{constraintSystem, numCircuitInputs, pk, witness, proofRand, 16, callback}
+    {}
+
+    std::size_t size() const { return m_proofs.size(); }
+
+    const PPZK_Proof<PAIRING>& operator[] (const std::size_t index) const {
+        return m_proofs[index];
+    }
+
+    const std::vector<PPZK_Proof<PAIRING>>& proofs() const { return m_proofs; }
+
+private:
+    std::vector<PPZK_Proof<PAIRING>> m_proofs;
+};
+
 template <typename PAIRING>
 std::ostream& operator<< (std::ostream& os, const PPZK_Proof<PAIRING>& a) {
     a.marshal_out(os);
@@ -79,6 +79,7 @@ public:
         m_base = rhs.m_base;
         m_coeffs = std::move(rhs.m_coeffs);
         m_encoded_terms = std::move(rhs.m_encoded_terms);
+        return *this;
     }
 
     void accumTable(const WindowExp<G1>& g1_table,
@@ -97,10 +98,14 @@ public:
             tsize = input_size();
 
         if (wsize < tsize) {
-            base = base + multiExp(
-                std::vector<G1>(m_encoded_terms.begin(),
-                                m_encoded_terms.begin() + wsize),
-                *witness);
+            // leading terms of query are not copied
+            const auto& terms = m_encoded_terms;
+            const auto& scalar = *witness;
+            base = base + multiExp<G1, Fr>(
+                wsize,
+                [&terms] (const std::size_t k) -> const G1& { return terms[k]; },
+                [&scalar] (const std::size_t k) -> const Fr& { return scalar[k]; },
+                nullptr);
 
             encoded_terms = std::vector<G1>(m_encoded_terms.begin() + wsize,
                                             m_encoded_terms.end());
@@ -48,16 +48,17 @@ public:
 
     void accumQuery(const SparseVector<Pairing<GA, GB>>& query,
                     const std::size_t reserveTune,
-                    ProgressCallback* callback) {
+                    ProgressCallback* callback,
+                    const MultiExpTable<Pairing<GA, GB>>* table = nullptr) {
         m_val = m_val
-            + (*m_random_d) * query.getElementForIndex(Z_INDEX)
-            + query.getElementForIndex(3)
+            + fixedTerms(query, *m_random_d)
             + multiExp01(query,
                          *m_witness,
                          4,
                          4 + m_numVariables,
                          0 == reserveTune ? reserveTune : m_numVariables / reserveTune,
-                         callback);
+                         callback,
+                         table);
     }
 
     void accumQuery(const SparseVector<Pairing<GA, GB>>& query,
@@ -67,7 +68,35 @@ public:
 
     const Pairing<GA, GB>& val() const { return m_val; }
 
+    // witness for each scalar vector of a batch, same as accumQuery()
+    // one at a time
+    static std::vector<Val> batchQuery(const SparseVector<Pairing<GA, GB>>& query,
+                                       const std::size_t qapNumVariables,
+                                       const std::vector<const std::vector<FR>*>& witness,
+                                       const std::vector<const FR*>& random_d,
+                                       ProgressCallback* callback = nullptr)
+    {
+#ifdef USE_ASSERT
+        assert(witness.size() == random_d.size());
+#endif
+
+        auto val = batchMultiExp01(query, witness, 4, 4 + qapNumVariables, callback);
+
+        for (std::size_t s = 0; s < val.size(); ++s)
+            val[s] = fixedTerms(query, *random_d[s]) + val[s];
+
+        return val;
+    }
+
 private:
+    // query terms not multiplied by the witness
+    static Val fixedTerms(const SparseVector<Pairing<GA, GB>>& query,
+                          const FR& random_d)
+    {
+        return random_d * query.getElementForIndex(Z_INDEX)
+            + query.getElementForIndex(3);
+    }
+
     std::size_t m_numVariables;
     const std::vector<FR>* m_witness;
     const FR* m_random_d;
@@ -105,6 +134,17 @@ public:
                                  callback);
     }
 
+    void accumQuery(const std::vector<G1>& query,
+                    const std::vector<Fr>& scalar,
+                    const MultiExpTable<G1>& table,
+                    ProgressCallback* callback = nullptr)
+    {
+        m_val = m_val + multiExp(query,
+                                 scalar,
+                                 table,
+                                 callback);
+    }
+
     void accumQuery(const BlockVector<G1>& query,
                     const BlockVector<Fr>& scalar,
                     ProgressCallback* callback = nullptr)
@@ -155,7 +195,8 @@ public:
 
     void accumQuery(const std::vector<G1>& query,
                     const std::size_t reserveTune,
-                    ProgressCallback* callback = nullptr)
+                    ProgressCallback* callback = nullptr,
+                    const MultiExpTable<G1>* table = nullptr)
     {
         const std::size_t startOffset = 4;
 
@@ -164,17 +205,15 @@ public:
 #endif
 
         m_val = m_val
-            + (*m_random_d1) * query[0]
-            + (*m_random_d2) * query[1]
-            + (*m_random_d3) * query[2]
-            + query[3]
+            + fixedTerms(query, *m_random_d1, *m_random_d2, *m_random_d3)
             + multiExp01(
                 query,
                 startOffset,
                 4,
                 *m_witness,
                 0 == reserveTune ? reserveTune : (query.size() - startOffset) / reserveTune,
-                callback);
+                callback,
+                table);
     }
 
     void accumQuery(const BlockVector<G1>& query,
@@ -189,10 +228,7 @@ public:
 #endif
 
             m_val = m_val
-                + (*m_random_d1) * query[0]
-                + (*m_random_d2) * query[1]
-                + (*m_random_d3) * query[2]
-                + query[3];
+                + fixedTerms(query, *m_random_d1, *m_random_d2, *m_random_d3);
 
             startOffset = 4;
         }
@@ -208,7 +244,46 @@ public:
 
     const G1& val() const { return m_val; }
 
+    // witness for each scalar vector of a batch, same as accumQuery()
+    // one at a time
+    static std::vector<G1> batchQuery(const std::vector<G1>& query,
+                                      const std::vector<const std::vector<Fr>*>& witness,
+                                      const std::vector<const Fr*>& random_d1,
+                                      const std::vector<const Fr*>& random_d2,
+                                      const std::vector<const Fr*>& random_d3,
+                                      ProgressCallback* callback = nullptr)
+    {
+#ifdef USE_ASSERT
+        assert(query.size() >= 4);
+        assert(witness.size() == random_d1.size() &&
+               witness.size() == random_d2.size() &&
+               witness.size() == random_d3.size());
+#endif
+
+        auto val = batchMultiExp01(query, 4, 4, witness, callback);
+
+        for (std::size_t s = 0; s < val.size(); ++s) {
+            val[s] = fixedTerms(query, *random_d1[s], *random_d2[s], *random_d3[s])
+                + val[s];
+        }
+
+        return val;
+    }
+
 private:
+    // query terms not multiplied by the witness
+    template <typename VEC>
+    static G1 fixedTerms(const VEC& query,
+                         const Fr& random_d1,
+                         const Fr& random_d2,
+                         const Fr& random_d3)
+    {
+        return random_d1 * query[0]
+            + random_d2 * query[1]
+            + random_d3 * query[2]
+            + query[3];
+    }
+
     const std::vector<Fr>* m_witness;
     const Fr* m_random_d1;
     const Fr* m_random_d2;
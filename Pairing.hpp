@@ -1,6 +1,7 @@
 #ifndef _SNARKLIB_PAIRING_HPP_
 #define _SNARKLIB_PAIRING_HPP_
 
+#include <array>
 #include <cstdint>
 #include <gmp.h>
 #include <istream>
@@ -10,6 +11,8 @@
 #include <snarklib/AuxSTL.hpp>
 #include <snarklib/BigInt.hpp>
 #include <snarklib/Group.hpp>
+#include <snarklib/MultiExp.hpp>
+#include <snarklib/Parallel.hpp>
 #include <snarklib/ProgressCallback.hpp>
 #include <snarklib/WindowExp.hpp>
 
@@ -42,7 +45,11 @@ public:
     }
 
     Pairing operator- () const {
-        return Pairing<GA, GB>(G(), -H());
+        return Pairing<GA, GB>(-G(), -H());
+    }
+
+    Pairing dbl() const {
+        return Pairing<GA, GB>(G().dbl(), H().dbl());
     }
 
     void toSpecial() {
@@ -170,6 +177,57 @@ SparseVector<Pairing<GA, GB>>& batchSpecial(SparseVector<Pairing<GA, GB>>& vec)
     return vec;
 }
 
+template <typename GA, typename GB>
+std::vector<Pairing<GA, GB>>& batchSpecial(std::vector<Pairing<GA, GB>>& vec)
+{
+    std::vector<GA> G_vec;
+    std::vector<GB> H_vec;
+    G_vec.reserve(vec.size());
+    H_vec.reserve(vec.size());
+
+    for (const auto& a : vec) {
+        G_vec.emplace_back(a.G());
+        H_vec.emplace_back(a.H());
+    }
+
+    batchSpecial(G_vec);
+    batchSpecial(H_vec);
+
+    for (std::size_t i = 0; i < vec.size(); ++i) {
+        vec[i] = Pairing<GA, GB>(G_vec[i], H_vec[i]);
+    }
+
+    return vec;
+}
+
+template <typename GA, typename GB>
+std::vector<Pairing<GA, GB>>& batchAddSpecial(std::vector<Pairing<GA, GB>>& a,
+                                              const std::vector<Pairing<GA, GB>>& b)
+{
+    std::vector<GA> aG_vec, bG_vec;
+    std::vector<GB> aH_vec, bH_vec;
+    aG_vec.reserve(a.size());
+    bG_vec.reserve(a.size());
+    aH_vec.reserve(a.size());
+    bH_vec.reserve(a.size());
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        aG_vec.emplace_back(a[i].G());
+        bG_vec.emplace_back(b[i].G());
+        aH_vec.emplace_back(a[i].H());
+        bH_vec.emplace_back(b[i].H());
+    }
+
+    batchAddSpecial(aG_vec, bG_vec);
+    batchAddSpecial(aH_vec, bH_vec);
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        a[i] = Pairing<GA, GB>(aG_vec[i], aH_vec[i]);
+    }
+
+    return a;
+}
+
 template <mp_size_t N, typename GA, typename GB>
 Pairing<GA, GB> wnafExp(const BigInt<N>& scalar,
                         const Pairing<GA, GB>& base)
@@ -189,45 +247,33 @@ SparseVector<Pairing<GA, GB>> batchExp_internal(
     const std::size_t stopIdx,
     ProgressCallback* callback)
 {
-    const std::size_t
-        M = callback ? callback->minorSteps() : 0,
-        N = stopIdx - startIdx;
+    const std::size_t N = stopIdx - startIdx;
+
+    // sparse vector position of each nonzero element
+    std::vector<std::size_t> position(N);
+    std::size_t count = 0;
+    for (std::size_t k = 0; k < N; ++k) {
+        position[k] = count;
+        if (! vec[startIdx + k].isZero()) ++count;
+    }
 
-    SparseVector<Pairing<GA, GB>> res(N, Pairing<GA, GB>::zero());
+    SparseVector<Pairing<GA, GB>> res(count, Pairing<GA, GB>::zero());
 
-    std::size_t index = startIdx, idx = 0;
+    // exponentiations are independent
+    Parallel::mapLambda(
+        N,
+        callback,
+        [&] (const std::size_t k) {
+            const std::size_t index = startIdx + k;
 
-    // full blocks
-    for (std::size_t j = 0; j < M; ++j) {
-        for (std::size_t k = 0; k < N / M; ++k) {
             if (! vec[index].isZero()) {
                 res.setIndexElement(
-                    idx++,
+                    position[k],
                     index,
                     Pairing<GA, GB>(tableA.exp(coeffA * vec[index]),
                                     tableB.exp(coeffB * vec[index])));
             }
-
-            ++index;
-        }
-
-        callback->minor();
-    }
-
-    // remaining steps smaller than one block
-    while (index < stopIdx) {
-        if (! vec[index].isZero()) {
-            res.setIndexElement(
-                idx++,
-                index,
-                Pairing<GA, GB>(tableA.exp(coeffA * vec[index]),
-                                tableB.exp(coeffB * vec[index])));
-        }
-
-        ++index;
-    }
-
-    res.resize(idx);
+        });
 
     return res;
 }
@@ -280,40 +326,21 @@ void batchExp_internal(
     const VEC& vec,
     ProgressCallback* callback)
 {
-    const std::size_t M = callback ? callback->minorSteps() : 0;
-    const std::size_t N = res.size(); // iterate over sparse vector directly
-
-    std::size_t idx = 0;
-
-    // full blocks
-    for (std::size_t j = 0; j < M; ++j) {
-        for (std::size_t k = 0; k < N / M; ++k) {
+    // iterate over sparse vector directly
+    Parallel::mapLambda(
+        res.size(),
+        callback,
+        [&] (const std::size_t idx) {
             const auto index = res.getIndex(idx);
             const auto& ga = res.getElement(idx).G();
             const auto& gb = res.getElement(idx).H();
 
             res.setIndexElement(
-                idx++,
+                idx,
                 index,
                 Pairing<GA, GB>(ga + tableA.exp(coeffA * vec[index]),
                                 gb + tableB.exp(coeffB * vec[index])));
-        }
-
-        callback->minor();
-    }
-
-    // remaining steps smaller than one block
-    while (idx < N) {
-        const auto index = res.getIndex(idx);
-        const auto& ga = res.getElement(idx).G();
-        const auto& gb = res.getElement(idx).H();
-
-        res.setIndexElement(
-            idx++,
-            index,
-            Pairing<GA, GB>(ga + tableA.exp(coeffA * vec[index]),
-                            gb + tableB.exp(coeffB * vec[index])));
-    }
+        });
 }
 
 // used with map-reduce
@@ -360,48 +387,74 @@ Pairing<GA, GB> multiExp01(const SparseVector<Pairing<GA, GB>>& base,
                            const std::size_t minIndex,
                            const std::size_t maxIndex,
                            const std::size_t reserveCount, // for performance tuning
-                           ProgressCallback* callback)
+                           ProgressCallback* callback,
+                           const MultiExpTable<Pairing<GA, GB>>* table = nullptr)
 {
-    const auto
-        ZERO = FR::zero(),
-        ONE = FR::one();
+    const auto ONE = FR::one();
 
-    std::vector<Pairing<GA, GB>> base2;
-    std::vector<FR> scalar2;
+    const mp_size_t N = FR::BaseType::numberLimbs();
+
+    // terms other than zero and one are multi-exponentiated in place
+    std::array<std::vector<std::size_t>, 4> index;
+    std::array<std::vector<BigInt<N>>, 4> value;
     if (reserveCount) {
-        base2.reserve(reserveCount);
-        scalar2.reserve(reserveCount);
+        index[3].reserve(reserveCount);
+        value[3].reserve(reserveCount);
     }
 
-    auto accum = Pairing<GA, GB>::zero();
-
-    for (std::size_t i = 0; i < base.size(); ++i) {
-        const auto idx = base.getIndex(i);
-
-        if (idx >= maxIndex) {
-            break;
-
-        } else if (idx >= minIndex) {
-            const auto& a = scalar[idx - minIndex];
-
-            if (ZERO == a) {
-                continue;
-
-            } else if (ONE == a) {
+    std::size_t stopIdx = 0;
+    while (stopIdx < base.size() && base.getIndex(stopIdx) < maxIndex)
+        ++stopIdx;
+
+    scalarClassIndex<FR>(
+        0,
+        stopIdx,
+        [&base, &scalar, minIndex] (const std::size_t i) -> const FR* {
+            const auto idx = base.getIndex(i);
+            return (idx >= minIndex) ? &scalar[idx - minIndex] : nullptr;
+        },
+        index,
+        value);
+
+    const auto accum = chunkSum<Pairing<GA, GB>>(
+        0,
+        stopIdx,
+        [&] (const std::size_t i, Pairing<GA, GB>& partialSum) {
+            const auto idx = base.getIndex(i);
+
+            if (idx >= minIndex && ONE == scalar[idx - minIndex]) {
 #ifdef USE_ADD_SPECIAL
-                accum = fastAddSpecial(accum, base.getElement(i));
+                partialSum = fastAddSpecial(partialSum, base.getElement(i));
 #else
-                accum = accum + base.getElement(i);
+                partialSum = partialSum + base.getElement(i);
 #endif
-
-            } else {
-                base2.emplace_back(base.getElement(i));
-                scalar2.emplace_back(a);
             }
-        }
-    }
-
-    return accum + multiExp(base2, scalar2, callback);
+        });
+
+    return accum + scalarClassExp<Pairing<GA, GB>>(
+        index,
+        value,
+        callback,
+        [&] (const std::vector<std::size_t>& idx,
+             const std::vector<BigInt<N>>& val,
+             ProgressCallback* cb) {
+            const auto baseTerm = [&base, &idx] (const std::size_t k) -> const Pairing<GA, GB>& {
+                return base.getElement(idx[k]);
+            };
+
+            const auto scalarTerm = [&val] (const std::size_t k) -> const BigInt<N>& {
+                return val[k];
+            };
+
+            return table
+                ? multiExp<Pairing<GA, GB>, FR>(idx.size(),
+                                                baseTerm,
+                                                [&idx] (const std::size_t k) { return idx[k]; },
+                                                *table,
+                                                scalarTerm,
+                                                cb)
+                : multiExp<Pairing<GA, GB>, FR>(idx.size(), baseTerm, scalarTerm, cb);
+        });
 }
 
 template <typename GA, typename GB, typename FR>
@@ -414,6 +467,46 @@ Pairing<GA, GB> multiExp01(const SparseVector<Pairing<GA, GB>>& base,
     return multiExp01(base, scalar, minIndex, maxIndex, 0, callback);
 }
 
+template <typename GA, typename GB, typename FR>
+std::vector<Pairing<GA, GB>> batchMultiExp01(const SparseVector<Pairing<GA, GB>>& base,
+                                             const std::vector<const std::vector<FR>*>& scalar,
+                                             const std::size_t minIndex,
+                                             const std::size_t maxIndex,
+                                             ProgressCallback* callback = nullptr)
+{
+    const auto ZERO = FR::zero();
+
+    // terms that are zero for every scalar vector are skipped
+    std::vector<std::size_t> index;
+
+    for (std::size_t i = 0; i < base.size(); ++i) {
+        const auto idx = base.getIndex(i);
+
+        if (idx >= maxIndex) {
+            break;
+
+        } else if (idx >= minIndex) {
+            for (const auto& a : scalar) {
+                if (ZERO != (*a)[idx - minIndex]) {
+                    index.push_back(i);
+                    break;
+                }
+            }
+        }
+    }
+
+    return batchMultiExp<Pairing<GA, GB>, FR>(
+        index.size(),
+        scalar.size(),
+        [&base, &index] (const std::size_t k) -> const Pairing<GA, GB>& {
+            return base.getElement(index[k]);
+        },
+        [&base, &scalar, &index, minIndex] (const std::size_t s, const std::size_t k) -> const FR& {
+            return (*scalar[s])[base.getIndex(index[k]) - minIndex];
+        },
+        callback);
+}
+
 } // namespace snarklib
 
 #endif
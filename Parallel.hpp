@@ -0,0 +1,100 @@
+#ifndef _SNARKLIB_PARALLEL_HPP_
+#define _SNARKLIB_PARALLEL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <snarklib/ProgressCallback.hpp>
+
+namespace snarklib {
+
+////////////////////////////////////////////////////////////////////////////////
+// Multithreading
+//
+// Work is divided into tasks which are independent of the number of
+// threads. Results are combined by the calling thread in task order so
+// output does not depend on how many threads are used.
+//
+
+class Parallel
+{
+public:
+    // number of worker threads (process wide, default is one)
+    static std::size_t numThreads() {
+        return threadCount();
+    }
+
+    // zero means one thread for each hardware core
+    static void numThreads(const std::size_t a) {
+        threadCount() = a ? a : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // calls func(task) for task = 0, 1, ... numTasks - 1
+    static void mapLambda(const std::size_t numTasks,
+                          std::function<void (std::size_t task)> func) {
+        const std::size_t N = std::min(numThreads(), numTasks);
+
+        if (N <= 1) {
+            for (std::size_t i = 0; i < numTasks; ++i)
+                func(i);
+
+            return;
+        }
+
+        std::atomic<std::size_t> nextTask(0);
+
+        const auto worker = [&nextTask, numTasks, &func] () {
+            for (std::size_t i = nextTask++; i < numTasks; i = nextTask++)
+                func(i);
+        };
+
+        // calling thread is also a worker
+        std::vector<std::thread> threads;
+        threads.reserve(N - 1);
+        for (std::size_t i = 1; i < N; ++i)
+            threads.emplace_back(worker);
+
+        worker();
+
+        for (auto& t : threads)
+            t.join();
+    }
+
+    // same as above with one progress callback minor step for each of
+    // the callback->minorSteps() full blocks of tasks
+    static void mapLambda(const std::size_t numTasks,
+                          ProgressCallback* callback,
+                          std::function<void (std::size_t task)> func) {
+        const std::size_t M = callback ? callback->minorSteps() : 0;
+
+        std::size_t i = 0;
+
+        // full blocks
+        for (std::size_t j = 0; j < M; ++j) {
+            mapLambda(numTasks / M,
+                      [i, &func] (const std::size_t k) { func(i + k); });
+
+            i += numTasks / M;
+
+            callback->minor();
+        }
+
+        // remaining tasks smaller than one block
+        mapLambda(numTasks - i,
+                  [i, &func] (const std::size_t k) { func(i + k); });
+    }
+
+private:
+    static std::atomic<std::size_t>& threadCount() {
+        static std::atomic<std::size_t> a(1);
+        return a;
+    }
+};
+
+} // namespace snarklib
+
+#endif
@@ -3,9 +3,16 @@
 
 #include <cassert>
 #include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include <vector>
 
+#include <snarklib/AuxSTL.hpp>
+#include <snarklib/HugeFFT.hpp>
 #include <snarklib/HugeSystem.hpp>
+#include <snarklib/IndexSpace.hpp>
 #include <snarklib/ProgressCallback.hpp>
 #include <snarklib/QAP_system.hpp>
 #include <snarklib/Rank1DSL.hpp>
@@ -50,15 +57,12 @@ public:
         // A, B, C
         constraintLoop(qap.constraintSystem());
 
-        qap.FFT()->iFFT(m_vecA);
-        qap.FFT()->iFFT(m_vecB);
-        qap.FFT()->iFFT(m_vecC);
+        qap.FFT()->batchiFFT({ &m_vecA, &m_vecB, &m_vecC });
     }
 
     void cosetFFT() {
-        m_qap.FFT()->cosetFFT(m_vecA, T::params.multiplicative_generator());
-        m_qap.FFT()->cosetFFT(m_vecB, T::params.multiplicative_generator());
-        m_qap.FFT()->cosetFFT(m_vecC, T::params.multiplicative_generator());
+        m_qap.FFT()->batchCosetFFT({ &m_vecA, &m_vecB, &m_vecC },
+                                   T::params.multiplicative_generator());
     }
 
     const std::vector<T>& vecA() const { return m_vecA; }
@@ -166,9 +170,13 @@ private:
         : m_vec(qap.degree(), T::zero())
     {
         for (std::size_t i = 0; i < m_vec.size(); ++i)
-            m_vec[i] =
-                ABC.vecA()[i] * ABC.vecB()[i] -
-                ABC.vecC()[i];
+            m_vec[i] = ABC.vecA()[i];
+
+        // products as arrays
+        mul_array(m_vec.data(), ABC.vecB().data(), m_vec.size());
+
+        for (std::size_t i = 0; i < m_vec.size(); ++i)
+            m_vec[i] -= ABC.vecC()[i];
 
         qap.FFT()->divide_by_Z_on_coset(m_vec);
 
@@ -210,6 +218,303 @@ private:
     std::vector<T> m_vec;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// witness vector H with A, B, C on disk
+// Same as QAP_WitnessABCH except the vectors are block partitioned
+// files transformed by HugeFFT, so memory is a few blocks and not
+// the QAP degree. No QAP_SystemPoint is needed as that constructs
+// the full evaluation domain. The degree must be a power of two
+// (basic radix-2 evaluation domain), otherwise this is an error. H
+// is written to files filePrefixH0,... over the index space hSpace
+// which may be partitioned like the H query.
+//
+
+template <template <typename> class SYS, typename T>
+class QAP_HugeWitnessABCH
+{
+public:
+    QAP_HugeWitnessABCH(const SYS<T>& constraintSystem,
+                        const std::size_t numCircuitInputs,
+                        const R1Witness<T>& witness,
+                        const T& random_d1,
+                        const T& random_d2,
+                        const T& random_d3,
+                        const std::string& filePrefix, // scratch files A, B, C, P
+                        const std::size_t numBlocks,   // for A, B, C, P
+                        const IndexSpace<1>& hSpace)   // for H
+        : m_witness(witness),
+          m_degree(LagrangeFFT<T>::getDegree(constraintSystem.size()
+#ifdef PARNO_SOUNDNESS_FIX
+                                             + numCircuitInputs
+#endif
+                                             + 1)),
+          m_error(false)
+    {
+#ifdef USE_ASSERT
+        assert(hSpace.globalID()[0] == m_degree + 1);
+#endif
+
+        const std::size_t N = m_degree;
+
+        // step domain is not supported
+        if (! HugeFFT<T>::supported(N, numBlocks)) {
+            m_error = true;
+            return;
+        }
+
+        const IndexSpace<1> space = HugeFFT<T>::space(N, numBlocks);
+
+        // removed on every return, even after an error
+        const ScratchFiles scratch(filePrefix, numBlocks);
+
+        BlockWriter
+            Awriter(filePrefix + "A", space),
+            Bwriter(filePrefix + "B", space),
+            Cwriter(filePrefix + "C", space);
+
+        const T g = T::params.multiplicative_generator();
+
+        // input consistency (for A only)
+#ifdef PARNO_SOUNDNESS_FIX
+        constraintLoop(constraintSystem, Awriter, Bwriter, Cwriter);
+
+        Awriter.push_back(T::one());
+        for (std::size_t i = 1; i <= numCircuitInputs; ++i)
+            Awriter.push_back(witness[i - 1]);
+#else
+        T A0 = T::one();
+        for (std::size_t i = 1; i <= numCircuitInputs; ++i)
+            A0 += witness[i - 1] * T(i + 1);
+
+        Awriter.push_back(A0);
+        Bwriter.push_back(T::zero());
+        Cwriter.push_back(T::zero());
+
+        constraintLoop(constraintSystem, Awriter, Bwriter, Cwriter);
+#endif
+
+        if (m_error ||
+            ! Awriter.finalize() ||
+            ! Bwriter.finalize() ||
+            ! Cwriter.finalize())
+        {
+            m_error = true;
+            return;
+        }
+
+        HugeFFT<T>
+            A(filePrefix + "A", N, numBlocks),
+            B(filePrefix + "B", N, numBlocks),
+            C(filePrefix + "C", N, numBlocks);
+
+        if (! A.iFFT() || ! B.iFFT() || ! C.iFFT()) {
+            m_error = true;
+            return;
+        }
+
+        // regular H without the leading coefficient random_d1 * random_d2
+        BlockWriter P(filePrefix + "P", space);
+
+        const T d12 = random_d1 * random_d2;
+
+        for (std::size_t block = 0; block < numBlocks; ++block) {
+            BlockVector<T> a, b;
+            if (! A.readBlock(block, a) || ! B.readBlock(block, b)) {
+                m_error = true;
+                return;
+            }
+
+            for (std::size_t i = a.startIndex(); i < a.stopIndex(); ++i) {
+                T h = random_d2 * a[i] + random_d1 * b[i];
+                if (0 == i) h -= random_d3 + d12;
+
+                P.push_back(h);
+            }
+        }
+
+        if (! P.finalize() ||
+            ! A.cosetFFT(g) || ! B.cosetFFT(g) || ! C.cosetFFT(g))
+        {
+            m_error = true;
+            return;
+        }
+
+        // temporary H replaces A
+        for (std::size_t block = 0; block < numBlocks; ++block) {
+            BlockVector<T> a, b, c;
+            if (! A.readBlock(block, a) ||
+                ! B.readBlock(block, b) ||
+                ! C.readBlock(block, c))
+            {
+                m_error = true;
+                return;
+            }
+
+            mul_array(a.lvec().data(), b.lvec().data(), a.lvec().size());
+
+            for (std::size_t i = a.startIndex(); i < a.stopIndex(); ++i)
+                a[i] -= c[i];
+
+            if (! A.writeBlock(a)) {
+                m_error = true;
+                return;
+            }
+        }
+
+        if (! A.divide_by_Z_on_coset() || ! A.icosetFFT(g)) {
+            m_error = true;
+            return;
+        }
+
+        // add regular and temporary H together
+        HugeFFT<T> Pfiles(filePrefix + "P", N, numBlocks);
+        BlockWriter H(filePrefix + "H", hSpace);
+
+        for (std::size_t block = 0; block < numBlocks; ++block) {
+            BlockVector<T> a, p;
+            if (! A.readBlock(block, a) || ! Pfiles.readBlock(block, p)) {
+                m_error = true;
+                return;
+            }
+
+            for (std::size_t i = a.startIndex(); i < a.stopIndex(); ++i)
+                H.push_back(p[i] + a[i]);
+        }
+
+        H.push_back(d12);
+
+        if (! H.finalize()) {
+            m_error = true;
+        }
+    }
+
+    std::size_t degree() const { return m_degree; }
+
+    // true if the degree is not supported or there was an error while
+    // reading or writing files
+    bool operator! () const { return m_error; }
+
+private:
+    // scratch files A, B, C, P (and partly transposed blocks) are
+    // deleted when this goes out of scope
+    class ScratchFiles
+    {
+    public:
+        ScratchFiles(const std::string& filePrefix,
+                     const std::size_t numBlocks)
+            : m_filePrefix(filePrefix),
+              m_numBlocks(numBlocks)
+        {}
+
+        ~ScratchFiles() {
+            for (const auto& s : { "A", "B", "C", "P" }) {
+                for (std::size_t block = 0; block < m_numBlocks; ++block) {
+                    std::stringstream ss;
+                    ss << m_filePrefix << s << block;
+                    std::remove(ss.str().c_str());
+                    std::remove((ss.str() + ".tmp").c_str());
+                }
+            }
+        }
+
+    private:
+        const std::string m_filePrefix;
+        const std::size_t m_numBlocks;
+    };
+
+    // vector written sequentially one block at a time
+    class BlockWriter
+    {
+    public:
+        BlockWriter(const std::string& filePrefix,
+                    const IndexSpace<1>& space)
+            : m_filePrefix(filePrefix),
+              m_space(space),
+              m_vec(space, 0),
+              m_index(0),
+              m_error(false)
+        {}
+
+        void push_back(const T& a) {
+#ifdef USE_ASSERT
+            assert(m_index < m_space.globalID()[0]);
+#endif
+
+            m_vec[m_index++] = a;
+
+            if (m_vec.stopIndex() == m_index) {
+                flushToFile();
+            }
+        }
+
+        // remaining elements are zero
+        bool finalize() {
+            while (m_index < m_space.globalID()[0]) {
+                push_back(T::zero());
+            }
+
+            return ! m_error;
+        }
+
+    private:
+        void flushToFile() {
+            const std::size_t block = m_vec.block()[0];
+
+            // consecutively numbered filenames
+            std::stringstream ss;
+            ss << m_filePrefix << block;
+
+            std::ofstream ofs(ss.str(), std::ios::binary);
+            if (!ofs) {
+                m_error = true; // failure
+            } else {
+                m_vec.marshal_out(
+                    ofs,
+                    [] (std::ostream& o, const T& a) { a.marshal_out_raw(o); });
+            }
+
+            if (block + 1 < m_space.blockID()[0]) {
+                m_vec = BlockVector<T>(m_space, block + 1);
+            }
+        }
+
+        const std::string m_filePrefix;
+        const IndexSpace<1> m_space;
+        BlockVector<T> m_vec;
+        std::size_t m_index;
+        bool m_error;
+    };
+
+    void constraintLoop(const R1System<T>& S,
+                        BlockWriter& A,
+                        BlockWriter& B,
+                        BlockWriter& C) {
+        for (const auto& constraint : S.constraints()) {
+            A.push_back(constraint.a() * m_witness);
+            B.push_back(constraint.b() * m_witness);
+            C.push_back(constraint.c() * m_witness);
+        }
+    }
+
+    void constraintLoop(const HugeSystem<T>& S,
+                        BlockWriter& A,
+                        BlockWriter& B,
+                        BlockWriter& C) {
+        if (! S.mapLambda(
+                [&] (const R1System<T>& a) -> bool {
+                    this->constraintLoop(a, A, B, C);
+                    return false; // do not write back to disk
+                }))
+        {
+            m_error = true;
+        }
+    }
+
+    const R1Witness<T>& m_witness;
+    const std::size_t m_degree;
+    bool m_error;
+};
+
 } // namespace snarklib
 
 #endif
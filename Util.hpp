@@ -1,6 +1,7 @@
 #ifndef _SNARKLIB_UTIL_HPP_
 #define _SNARKLIB_UTIL_HPP_
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <fstream>
@@ -12,6 +13,7 @@
 
 #include <snarklib/AuxSTL.hpp>
 #include <snarklib/IndexSpace.hpp>
+#include <snarklib/Parallel.hpp>
 
 namespace snarklib {
 
@@ -43,30 +45,90 @@ T bit_reverse(T n, const std::size_t l) {
     return r;
 }
 
+// Montgomery batch inversion of n elements with one field inversion
 template <typename T>
-void batch_invert(std::vector<T>& vec) {
+void batch_invert(T* a, const std::size_t n) {
+    // longer arrays are eight interleaved products so the
+    // multiplications are arrays of eight at a time
+    if (n >= 64) {
+        std::vector<T> prod(n), accum(8, T::one()), orig(8);
+
+        for (std::size_t i = 0; i < n; i += 8) {
+            const std::size_t len = std::min(n - i, std::size_t(8));
+
+            for (std::size_t j = 0; j < len; ++j) {
+#ifdef USE_ASSERT
+                assert(! a[i + j].isZero());
+#endif
+                prod[i + j] = accum[j];
+            }
+
+            mul_array(accum.data(), a + i, len);
+        }
+
+        // eight inversions in one
+        batch_invert(accum.data(), 8);
+
+        for (std::size_t i = (n - 1) / 8 * 8; ; i -= 8) {
+            const std::size_t len = std::min(n - i, std::size_t(8));
+
+            for (std::size_t j = 0; j < len; ++j) {
+                orig[j] = a[i + j];
+                a[i + j] = prod[i + j];
+            }
+
+            mul_array(a + i, accum.data(), len);
+            mul_array(accum.data(), orig.data(), len);
+
+            if (0 == i) break;
+        }
+
+        return;
+    }
+
     std::vector<T> prod;
-    prod.reserve(vec.size());
+    prod.reserve(n);
 
     T accum = T::one();
 
-    for (const auto& elem : vec) {
+    for (std::size_t i = 0; i < n; ++i) {
 #ifdef USE_ASSERT
-        assert(! elem.isZero());
+        assert(! a[i].isZero());
 #endif
         prod.push_back(accum);
-        accum = accum * elem;
+        accum = accum * a[i];
     }
 
     T accum_inv = inverse(accum);
 
-    for (long i = vec.size() - 1; i >= 0; --i) {
-        const auto orig = vec[i];
-        vec[i] = accum_inv * prod[i];
+    for (std::size_t i = n; i-- > 0; ) {
+        const auto orig = a[i];
+        a[i] = accum_inv * prod[i];
         accum_inv = accum_inv * orig;
     }
 }
 
+template <typename T>
+void batch_invert(std::vector<T>& vec) {
+    batch_invert(vec.data(), vec.size());
+}
+
+// blocks of 2^14 elements are batch inverted in parallel, one field
+// inversion each (not for use inside tasks already in parallel)
+template <typename T>
+void batch_invert_parallel(std::vector<T>& vec) {
+    const std::size_t
+        blockSize = std::size_t(1) << 14,
+        numBlocks = (vec.size() + blockSize - 1) / blockSize;
+
+    Parallel::mapLambda(
+        numBlocks,
+        [&] (const std::size_t block) {
+            const std::size_t start = block * blockSize;
+            batch_invert(vec.data() + start, std::min(blockSize, vec.size() - start));
+        });
+}
+
 // returns true if big-endian
 template <typename T>
 bool is_big_endian() {
@@ -1,15 +1,27 @@
 #ifndef _SNARKLIB_WINDOW_EXP_HPP_
 #define _SNARKLIB_WINDOW_EXP_HPP_
 
+#include <array>
 #include <cassert>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
 #include <gmp.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <vector>
 
 #include <snarklib/AuxSTL.hpp>
 #include <snarklib/BigInt.hpp>
 #include <snarklib/Group.hpp>
 #include <snarklib/IndexSpace.hpp>
+#include <snarklib/Parallel.hpp>
 #include <snarklib/ProgressCallback.hpp>
 
 namespace snarklib {
@@ -17,10 +29,16 @@ namespace snarklib {
 ////////////////////////////////////////////////////////////////////////////////
 // Window table made from powers of group generator
 //
+// The monolithic table may instead be a Lim-Lee comb. Each comb row is
+// indexed by one bit from each of windowBits teeth spaced numWindows()
+// bits apart. Exponentiation is combSpacing doublings, each followed by
+// an addition from every row. This trades table size for doublings.
+//
 
 template <typename GROUP>
 class WindowExp
 {
+    typedef typename GROUP::BaseField BaseField;
     typedef typename GROUP::ScalarField Fr;
 
 public:
@@ -38,12 +56,58 @@ public:
 
     // one-dimensional index space over windows (rows)
     static IndexSpace<1> space(const std::size_t expCount) {
-        const auto wb = windowBits(expCount);
+        return windowSpace(windowBits(expCount));
+    }
 
-        IndexSpace<1> a(numWindows(wb));
-        a.param(wb);
+    // least cost table for expCount exponentiations and table memory of
+    // at most maxTableBytes (or smallest possible), returns window bits
+    // (comb teeth) and comb spacing (zero for window table)
+    static std::array<std::size_t, 2> engine(const std::size_t expCount,
+                                             const std::size_t maxTableBytes) {
+        const std::size_t
+            elementBytes = 2 * sizeof(BaseField),
+            maxBits = 22; // table rows larger than this are unreasonable
+
+        // cost counts additions and doublings the same, table building
+        // is one addition for each element
+        std::array<std::size_t, 2> best{ 0, 0 };
+        std::size_t bestCost = -1;
+
+        for (std::size_t wb = 1; wb <= maxBits; ++wb) {
+            const std::size_t
+                rowBytes = windowSize(wb) * elementBytes,
+                spacing = numWindows(wb);
+
+            // window table
+            if (spacing * rowBytes <= maxTableBytes) {
+                const std::size_t cost
+                    = spacing * windowSize(wb) + expCount * spacing;
+
+                if (cost < bestCost) {
+                    best = { wb, 0 };
+                    bestCost = cost;
+                }
+            }
 
-        return a;
+            // comb tables, fewest rows for each number of doublings
+            for (std::size_t dbls = 1; dbls <= spacing; ++dbls) {
+                const std::size_t rows = (spacing + dbls - 1) / dbls;
+                if (rows * rowBytes > maxTableBytes) continue;
+
+                const std::size_t cost
+                    = rows * windowSize(wb) + expCount * (rows + 1) * dbls;
+
+                if (cost < bestCost) {
+                    best = { wb, dbls };
+                    bestCost = cost;
+                }
+            }
+        }
+
+        // nothing fits, smallest comb table is two elements
+        if (0 == best[0]) best = { 1, numBits() };
+
+        return best;
     }
 
     const IndexSpace<1>& space() const { return m_space; }
@@ -53,8 +117,11 @@ public:
     WindowExp()
         : m_space(),
           m_windowBits(0),
+          m_combSpacing(0),
           m_block{0},
-          m_powers_of_g()
+          m_numRows(0),
+          m_powers_of_g(),
+          m_mapped()
     {}
 
     // map-reduce version
@@ -63,39 +130,39 @@ public:
               const GROUP generator = GROUP::one())
         : m_space(space),
           m_windowBits(space.param()[0]),
+          m_combSpacing(0),
           m_block(block),
-          m_powers_of_g(space.indexSize(m_block)[0],
-                        std::vector<GROUP>(windowSize(), GROUP::zero()))
+          m_numRows(space.indexSize(m_block)[0]),
+          m_powers_of_g(),
+          m_mapped()
     {
-        GROUP outerG = generator;
-        const std::size_t startLen = startRow() * m_windowBits;
-        for (std::size_t i = 0; i < startLen; ++i)
-            outerG = outerG + outerG;
+        // every power of zero is zero, the table is left empty
+        if (generator.isZero()) return;
 
-        const std::size_t N = m_powers_of_g.size();
-        const bool lastBlock = block[0] == space.blockID()[0] - 1;
+        m_powers_of_g.resize(tableSize());
 
-        // iterate over window rows
-        for (std::size_t outer = 0; outer < N; ++outer) {
-            GROUP innerG = GROUP::zero();
+        GROUP outerG = generator;
+        const std::size_t startLen = startRow() * m_windowBits;
+        if (GROUP::hasEndomorphism() && startLen) {
+            // 2^startLen * generator with half as many doublings
+            outerG = power(Fr(2ul), startLen) * generator;
 
-            const bool lastRow = lastBlock && outer == N - 1;
+        } else {
+            for (std::size_t i = 0; i < startLen; ++i)
+                outerG = outerG + outerG;
+        }
 
-            const std::size_t cur_in_window = lastRow
-                ? lastInWindow()
-                : m_powers_of_g[outer].size();
+        const std::size_t N = m_numRows;
+        const bool lastBlock = block[0] == space.blockID()[0] - 1;
 
-            // iterate inside window
-            for (std::size_t inner = 0; inner < cur_in_window; ++inner) {
-                m_powers_of_g[outer][inner] = innerG;
-                innerG = innerG + outerG;
-            }
+        const auto rowG = rowStart(outerG);
 
-            if (! lastRow) {
-                for (std::size_t i = 0; i < m_windowBits; ++i)
-                    outerG = outerG + outerG;
-            }
-        }
+        // window rows are independent
+        Parallel::mapLambda(
+            N,
+            [&] (const std::size_t outer) {
+                fillRow(outer, rowG[outer], lastBlock && outer == N - 1);
+            });
     }
 
     WindowExp(const IndexSpace<1>& space,
@@ -110,75 +177,111 @@ public:
               const GROUP generator = GROUP::one())
         : m_space(space(expCount)),
           m_windowBits(m_space.param()[0]),
+          m_combSpacing(0),
           m_block{0},
-          m_powers_of_g(m_space.indexSize(m_block)[0],
-                        std::vector<GROUP>(windowSize(), GROUP::zero()))
+          m_numRows(m_space.indexSize(m_block)[0]),
+          m_powers_of_g(),
+          m_mapped()
     {
-        const std::size_t N = m_powers_of_g.size();
-        const std::size_t M = callback ? callback->minorSteps() : 0;
+        fillTable(generator, callback);
+    }
 
-        GROUP outerG = generator;
+    // monolithic version with window or comb table, whichever is faster
+    // for expCount exponentiations in at most maxTableBytes of memory
+    WindowExp(const std::size_t expCount,
+              const std::size_t maxTableBytes,
+              ProgressCallback* callback = nullptr,
+              const GROUP generator = GROUP::one())
+        : WindowExp{engine(expCount, maxTableBytes), callback, generator}
+    {}
 
-        std::size_t outer = 0;
+    // monolithic version with table cached in a file
+    //
+    // The file is in directory cacheDir and named by a hash of the curve,
+    // group, generator and window size. It is memory mapped if it exists,
+    // and its header and checksum match. Otherwise the table is made and
+    // written to the file for the next time.
+    //
+    WindowExp(const std::size_t expCount,
+              const std::string& cacheDir,
+              ProgressCallback* callback = nullptr,
+              const GROUP generator = GROUP::one())
+        : m_space(space(expCount)),
+          m_windowBits(m_space.param()[0]),
+          m_combSpacing(0),
+          m_block{0},
+          m_numRows(m_space.indexSize(m_block)[0]),
+          m_powers_of_g(),
+          m_mapped()
+    {
+        if (generator.isZero()) {
+            fillTable(generator, callback);
+            return;
+        }
 
-        // full blocks
-        for (std::size_t j = 0; j < M; ++j) {
-            for (std::size_t k = 0; k < N / M; ++k) {
-                GROUP innerG = GROUP::zero();
+        const auto key = cacheKey(generator);
+        const auto filename = cacheFile(cacheDir, key);
 
-                const bool lastRow = (outer == N - 1);
+        if (mapFile(filename, key)) {
+            const std::size_t M = callback ? callback->minorSteps() : 0;
+            for (std::size_t j = 0; j < M; ++j)
+                callback->minor();
 
-                const std::size_t cur_in_window = lastRow
-                    ? lastInWindow()
-                    : m_powers_of_g[outer].size();
+        } else {
+            fillTable(generator, callback);
+            writeFile(filename, key);
+        }
+    }
 
-                for (std::size_t inner = 0; inner < cur_in_window; ++inner) {
-                    m_powers_of_g[outer][inner] = innerG;
-                    innerG = innerG + outerG;
-                }
+    // true if table is memory mapped from a cache file
+    bool mapped() const { return bool(m_mapped); }
 
-                if (! lastRow) {
-                    for (std::size_t i = 0; i < m_windowBits; ++i)
-                        outerG = outerG + outerG;
-                }
+    // works for both map-reduce and monolithic versions
+    GROUP exp(const Fr& exponent) const {
+        const auto pow_val = exponent[0].asBigInt();
+        GROUP res = GROUP::zero();
 
-                ++outer;
-            }
+        const auto table = data();
+        if (! table) return res;
 
-            callback->minor();
-        }
+        const auto ONE = BaseField::one();
+
+        // first element of each row is zero
+        const auto addElement = [&] (const std::size_t j, const std::size_t inner) {
+            const auto a = table + 2 * (j * windowSize() + inner);
 
-        // remaining steps smaller than one block
-        while (outer < N) {
-            GROUP innerG = GROUP::zero();
+#ifdef USE_ADD_SPECIAL
+            res = fastAddSpecial(res, GROUP(a[0], a[1], ONE));
+#else
+            res = res + GROUP(a[0], a[1], ONE);
+#endif
+        };
 
-            const bool lastRow = (outer == N - 1);
+        if (m_combSpacing) {
+            const std::size_t teethSpacing = numWindows();
 
-            const std::size_t cur_in_window = lastRow
-                ? lastInWindow()
-                : m_powers_of_g[outer].size();
+            for (std::size_t k = m_combSpacing; k-- > 0; ) {
+                res = res.dbl();
 
-            for (std::size_t inner = 0; inner < cur_in_window; ++inner) {
-                m_powers_of_g[outer][inner] = innerG;
-                innerG = innerG + outerG;
-            }
+                for (std::size_t j = 0; j < m_numRows; ++j) {
+                    const std::size_t offset = j * m_combSpacing + k;
+                    if (offset >= teethSpacing) break;
 
-            if (! lastRow) {
-                for (std::size_t i = 0; i < m_windowBits; ++i)
-                    outerG = outerG + outerG;
+                    std::size_t inner = 0;
+                    for (std::size_t i = 0; i < m_windowBits; ++i) {
+                        if (pow_val.testBit(i * teethSpacing + offset))
+                            inner |= 1u << i;
+                    }
+
+                    if (inner) addElement(j, inner);
+                }
             }
 
-            ++outer;
+            return res;
         }
-    }
-
-    // works for both map-reduce and monolithic versions
-    GROUP exp(const Fr& exponent) const {
-        const auto pow_val = exponent[0].asBigInt();
-        GROUP res = GROUP::zero();
 
         const std::size_t offset = startRow();
-        for (std::size_t j = 0; j < m_powers_of_g.size(); ++j) {
+        for (std::size_t j = 0; j < m_numRows; ++j) {
             const std::size_t outer = offset + j;
 
             std::size_t inner = 0;
@@ -187,7 +290,7 @@ public:
                     inner |= 1u << i;
             }
 
-            res = res + m_powers_of_g[j][inner];
+            if (inner) addElement(j, inner);
         }
 
         return res;
@@ -197,28 +300,15 @@ public:
     std::vector<GROUP> batchExp(const std::vector<Fr>& exponentVec,
                                 ProgressCallback* callback = nullptr) const
     {
-        const std::size_t N = exponentVec.size();
-        const std::size_t M = callback ? callback->minorSteps() : 0;
+        std::vector<GROUP> res(exponentVec.size(), GROUP::zero());
 
-        std::vector<GROUP> res(N, GROUP::zero());
-
-        std::size_t i = 0;
-
-        // for full blocks
-        for (std::size_t j = 0; j < M; ++j) {
-            for (std::size_t k = 0; k < N / M; ++k) {
+        // exponentiations are independent
+        Parallel::mapLambda(
+            exponentVec.size(),
+            callback,
+            [&] (const std::size_t i) {
                 res[i] = exp(exponentVec[i]);
-                ++i;
-            }
-
-            callback->minor();
-        }
-
-        // remaining steps smaller than one block
-        while (i < N) {
-            res[i] = exp(exponentVec[i]);
-            ++i;
-        }
+            });
 
         return res;
     }
@@ -232,26 +322,12 @@ public:
         assert(res.size() == exponentVec.size());
 #endif
 
-        const std::size_t N = exponentVec.size();
-        const std::size_t M = callback ? callback->minorSteps() : 0;
-
-        std::size_t i = 0;
-
-        // for full blocks
-        for (std::size_t j = 0; j < M; ++j) {
-            for (std::size_t k = 0; k < N / M; ++k) {
+        Parallel::mapLambda(
+            exponentVec.size(),
+            callback,
+            [&] (const std::size_t i) {
                 res[i] = res[i] + exp(exponentVec[i]);
-                ++i;
-            }
-
-            callback->minor();
-        }
-
-        // remaining steps smaller than one block
-        while (i < N) {
-            res[i] = res[i] + exp(exponentVec[i]);
-            ++i;
-        }
+            });
     }
 
     // works for both map-reduce and monolithic versions
@@ -259,28 +335,16 @@ public:
     BlockVector<GROUP> batchExp(const BlockVector<Fr>& exponentVec,
                                 ProgressCallback* callback = nullptr) const
     {
-        const std::size_t N = exponentVec.size();
-        const std::size_t M = callback ? callback->minorSteps() : 0;
+        const std::size_t startIdx = exponentVec.startIndex();
 
         BlockVector<GROUP> res(exponentVec.space(), exponentVec.block());
 
-        std::size_t i = exponentVec.startIndex();
-
-        // for full blocks
-        for (std::size_t j = 0; j < M; ++j) {
-            for (std::size_t k = 0; k < N / M; ++k) {
-                res[i] = exp(exponentVec[i]);
-                ++i;
-            }
-
-            callback->minor();
-        }
-
-        // remaining steps smaller than one block
-        while (i < exponentVec.stopIndex()) {
-            res[i] = exp(exponentVec[i]);
-            ++i;
-        }
+        Parallel::mapLambda(
+            exponentVec.stopIndex() - startIdx,
+            callback,
+            [&] (const std::size_t k) {
+                res[startIdx + k] = exp(exponentVec[startIdx + k]);
+            });
 
         return res;
     }
@@ -296,29 +360,324 @@ public:
                res.block() == exponentVec.block());
 #endif
 
-        const std::size_t N = exponentVec.size();
-        const std::size_t M = callback ? callback->minorSteps() : 0;
-
-        std::size_t i = exponentVec.startIndex();
+        const std::size_t startIdx = exponentVec.startIndex();
 
-        // for full blocks
-        for (std::size_t j = 0; j < M; ++j) {
-            for (std::size_t k = 0; k < N / M; ++k) {
+        Parallel::mapLambda(
+            exponentVec.stopIndex() - startIdx,
+            callback,
+            [&] (const std::size_t k) {
+                const std::size_t i = startIdx + k;
                 res[i] = res[i] + exp(exponentVec[i]);
-                ++i;
+            });
+    }
+
+private:
+    // monolithic version with window bits (comb teeth) and comb spacing
+    WindowExp(const std::array<std::size_t, 2>& param,
+              ProgressCallback* callback,
+              const GROUP& generator)
+        : m_space(param[1] ? IndexSpace<1>() : windowSpace(param[0])),
+          m_windowBits(param[0]),
+          m_combSpacing(param[1]),
+          m_block{0},
+          m_numRows(param[1]
+                    ? (numWindows(param[0]) + param[1] - 1) / param[1]
+                    : numWindows(param[0])),
+          m_powers_of_g(),
+          m_mapped()
+    {
+        fillTable(generator, callback);
+    }
+
+    static IndexSpace<1> windowSpace(const std::size_t wb) {
+        IndexSpace<1> a(numWindows(wb));
+        a.param(wb);
+
+        return a;
+    }
+
+    // cache file header, 64 bytes so the table after it stays aligned
+    struct FileHeader
+    {
+        char magic[8];
+        std::uint64_t version;
+        std::uint64_t elementBytes;
+        std::uint64_t windowBits;
+        std::uint64_t numRows;
+        std::uint64_t tableBytes;
+        std::uint64_t key;
+        std::uint64_t checksum;
+    };
+
+    static constexpr std::uint64_t fileVersion() { return 1; }
+
+    // FNV-1a over 64-bit words
+    static std::uint64_t hashWords(const void* p,
+                                   const std::size_t numBytes,
+                                   std::uint64_t h = 0xcbf29ce484222325ul) {
+        const char* a = static_cast<const char*>(p);
+
+        for (std::size_t i = 0; i + 8 <= numBytes; i += 8) {
+            std::uint64_t w;
+            std::memcpy(&w, a + i, 8);
+            h = (h ^ w) * 0x100000001b3ul;
+        }
+
+        return h;
+    }
+
+    std::size_t tableSize() const {
+        return 2 * m_numRows * windowSize();
+    }
+
+    const BaseField* data() const {
+        return m_mapped
+            ? m_mapped.get()
+            : (m_powers_of_g.empty() ? nullptr : m_powers_of_g.data());
+    }
+
+    // table depends on the base field modulus (through one in Montgomery
+    // form), the group generator, the window size and the file format
+    std::uint64_t cacheKey(const GROUP& generator) const {
+        auto g = generator;
+        g.toSpecial();
+
+        const auto ONE = BaseField::one();
+
+        const std::uint64_t param[] = {
+            fileVersion(), sizeof(BaseField), numBits(), m_windowBits, m_numRows };
+
+        auto h = hashWords(param, sizeof(param));
+        h = hashWords(&ONE, sizeof(BaseField), h);
+        h = hashWords(&g.x(), sizeof(BaseField), h);
+        return hashWords(&g.y(), sizeof(BaseField), h);
+    }
+
+    static std::string cacheFile(const std::string& cacheDir,
+                                 const std::uint64_t key) {
+        std::stringstream ss;
+        ss << cacheDir << "/WindowExp_" << std::hex << key << ".bin";
+        return ss.str();
+    }
+
+    FileHeader fileHeader(const std::uint64_t key,
+                          const std::uint64_t checksum) const {
+        FileHeader h;
+        std::memcpy(h.magic, "snarkWXP", 8);
+        h.version = fileVersion();
+        h.elementBytes = sizeof(BaseField);
+        h.windowBits = m_windowBits;
+        h.numRows = m_numRows;
+        h.tableBytes = tableSize() * sizeof(BaseField);
+        h.key = key;
+        h.checksum = checksum;
+        return h;
+    }
+
+    // memory map table from cache file, false if missing or stale
+    bool mapFile(const std::string& filename,
+                 const std::uint64_t key) {
+        const std::size_t
+            tableBytes = tableSize() * sizeof(BaseField),
+            fileBytes = sizeof(FileHeader) + tableBytes;
+
+        const int fd = open(filename.c_str(), O_RDONLY);
+        if (-1 == fd) return false;
+
+        struct stat st;
+        void* p = MAP_FAILED;
+        if (0 == fstat(fd, &st) && fileBytes == static_cast<std::size_t>(st.st_size))
+            p = mmap(nullptr, fileBytes, PROT_READ, MAP_SHARED, fd, 0);
+
+        close(fd);
+        if (MAP_FAILED == p) return false;
+
+        // unmapped when the last copy of the table goes away
+        const std::shared_ptr<const char> region(
+            static_cast<const char*>(p),
+            [fileBytes] (const char* a) { munmap(const_cast<char*>(a), fileBytes); });
+
+        const char* table = region.get() + sizeof(FileHeader);
+
+        FileHeader h;
+        std::memcpy(&h, region.get(), sizeof(FileHeader));
+
+        const auto expected = fileHeader(key, h.checksum);
+        if (0 != std::memcmp(&h, &expected, sizeof(FileHeader)) ||
+            hashWords(table, tableBytes) != h.checksum) {
+            return false;
+        }
+
+        m_mapped = std::shared_ptr<const BaseField>(
+            region,
+            reinterpret_cast<const BaseField*>(table));
+
+        return true;
+    }
+
+    // write table to cache file, another process may read the file
+    // only after it is renamed to the final name
+    void writeFile(const std::string& filename,
+                   const std::uint64_t key) const {
+        const std::size_t tableBytes = tableSize() * sizeof(BaseField);
+
+        const auto h = fileHeader(key, hashWords(m_powers_of_g.data(), tableBytes));
+
+        std::stringstream ss;
+        ss << filename << ".tmp" << getpid();
+        const auto tmpname = ss.str();
+
+        std::ofstream ofs(tmpname, std::ios::binary);
+        ofs.write(reinterpret_cast<const char*>(&h), sizeof(FileHeader));
+        ofs.write(reinterpret_cast<const char*>(m_powers_of_g.data()), tableBytes);
+        ofs.close();
+
+        if (! ofs || 0 != std::rename(tmpname.c_str(), filename.c_str()))
+            std::remove(tmpname.c_str());
+    }
+
+    // monolithic table with progress bar
+    void fillTable(const GROUP& generator,
+                   ProgressCallback* callback) {
+        const std::size_t N = m_numRows;
+
+        // every power of zero is zero, the table is left empty
+        if (generator.isZero()) {
+            const std::size_t M = callback ? callback->minorSteps() : 0;
+            for (std::size_t j = 0; j < M; ++j)
+                callback->minor();
+
+            return;
+        }
+
+        m_powers_of_g.resize(tableSize());
+
+        if (m_combSpacing) {
+            const auto teeth = combTeeth(generator);
+
+            // comb rows are independent
+            Parallel::mapLambda(
+                N,
+                callback,
+                [&] (const std::size_t j) {
+                    fillCombRow(j, teeth.data() + j * m_windowBits);
+                });
+
+            return;
+        }
+
+        const auto rowG = rowStart(generator);
+
+        // window rows are independent
+        Parallel::mapLambda(
+            N,
+            callback,
+            [&] (const std::size_t outer) {
+                fillRow(outer, rowG[outer], outer == N - 1);
+            });
+    }
+
+    // comb teeth for all rows, tooth i of row j is generator times
+    // 2^(i * numWindows() + j * m_combSpacing)
+    std::vector<GROUP> combTeeth(const GROUP& generator) const {
+        std::vector<GROUP> teeth;
+        teeth.reserve(m_numRows * m_windowBits);
+
+        GROUP toothG = generator;
+        for (std::size_t i = 0; i < m_windowBits; ++i) {
+            teeth.emplace_back(toothG);
+
+            for (std::size_t k = 0; k < numWindows(); ++k)
+                toothG = toothG.dbl();
+        }
+
+        for (std::size_t j = 1; j < m_numRows; ++j) {
+            for (std::size_t i = 0; i < m_windowBits; ++i) {
+                toothG = teeth[(j - 1) * m_windowBits + i];
+
+                for (std::size_t k = 0; k < m_combSpacing; ++k)
+                    toothG = toothG.dbl();
+
+                teeth.emplace_back(toothG);
             }
+        }
 
-            callback->minor();
+        return teeth;
+    }
+
+    // sums of comb teeth subsets for one row
+    void fillCombRow(const std::size_t j,
+                     const GROUP* teeth) {
+        std::vector<GROUP> row;
+        row.reserve(windowSize());
+
+        row.emplace_back(GROUP::zero());
+        for (std::size_t i = 0; i < m_windowBits; ++i) {
+            for (std::size_t inner = 0; inner < windowSize(i); ++inner)
+                row.emplace_back(row[inner] + teeth[i]);
         }
 
-        // remaining steps smaller than one block
-        while (i < exponentVec.stopIndex()) {
-            res[i] = res[i] + exp(exponentVec[i]);
-            ++i;
+        storeRow(j, row);
+    }
+
+    // first element of each window row, the row starting points are
+    // found up front so rows can be filled in any order
+    std::vector<GROUP> rowStart(GROUP outerG) const {
+        const std::size_t N = m_numRows;
+
+        std::vector<GROUP> rowG;
+        rowG.reserve(N);
+
+        for (std::size_t outer = 0; outer < N; ++outer) {
+            rowG.emplace_back(outerG);
+
+            if (outer < N - 1) {
+                for (std::size_t i = 0; i < m_windowBits; ++i)
+                    outerG = outerG + outerG;
+            }
+        }
+
+        return rowG;
+    }
+
+    // multiples of outerG for one window row
+    void fillRow(const std::size_t outer,
+                 const GROUP& outerG,
+                 const bool lastRow) {
+        const std::size_t cur_in_window = lastRow
+            ? lastInWindow()
+            : windowSize();
+
+        std::vector<GROUP> row;
+        row.reserve(cur_in_window);
+
+        GROUP innerG = GROUP::zero();
+        for (std::size_t inner = 0; inner < cur_in_window; ++inner) {
+            row.emplace_back(innerG);
+            innerG = innerG + outerG;
+        }
+
+        storeRow(outer, row);
+    }
+
+    // row converted to special form and stored as affine x and y
+    void storeRow(const std::size_t outer,
+                  std::vector<GROUP>& row) {
+#ifdef USE_ASSERT
+        // only the first element has no affine form
+        for (std::size_t inner = 1; inner < row.size(); ++inner)
+            assert(! row[inner].isZero());
+#endif
+
+        batchSpecial(row);
+
+        auto a = m_powers_of_g.begin() + 2 * outer * windowSize();
+        for (const auto& b : row) {
+            *a++ = b.x();
+            *a++ = b.y();
         }
     }
 
-private:
     static std::size_t numBits() {
         return GROUP::ScalarField::BaseType::sizeInBits();
     }
@@ -344,9 +703,16 @@ private:
     }
 
     const IndexSpace<1> m_space;
-    const std::size_t m_windowBits;
+    const std::size_t m_windowBits, m_combSpacing;
     const std::array<std::size_t, 1> m_block;
-    std::vector<std::vector<GROUP>> m_powers_of_g;
+    const std::size_t m_numRows;
+
+    // rows of windowSize() elements, each element is x and y in special
+    // form (z is one) so exponentiation uses mixed addition
+    std::vector<BaseField, AlignedAllocator<BaseField>> m_powers_of_g;
+
+    // table memory mapped from cache file instead
+    std::shared_ptr<const BaseField> m_mapped;
 };
 
 } // namespace snarklib
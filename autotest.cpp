@@ -167,6 +167,24 @@ void add_Field_cyclotomic_exp(AutoTestBattery& ATB)
     }
 }
 
+template <typename T>
+void add_Field_mulxADX(AutoTestBattery& ATB)
+{
+    // defined for only: Fp
+    ATB.addTest(new AutoTest_FieldMulxADX<T>(0));
+    ATB.addTest(new AutoTest_FieldMulxADX<T>(100));
+}
+
+template <typename T>
+void add_Field_mul_array(AutoTestBattery& ATB)
+{
+    ATB.addTest(new AutoTest_FieldMulArray<T>(0, 1, 1));
+    ATB.addTest(new AutoTest_FieldMulArray<T>(7, 1, 1));
+    ATB.addTest(new AutoTest_FieldMulArray<T>(1000, 1, 1));
+    ATB.addTest(new AutoTest_FieldMulArray<T>(100, 3, 5));
+    ATB.addTest(new AutoTest_FieldMulArray<T>(100, 1, 0));
+}
+
 #ifdef CURVE_ALT_BN128
 void add_Field_mul_by_024(AutoTestBattery& ATB)
 {
@@ -198,6 +216,8 @@ void add_Group(AutoTestBattery& ATB)
         ATB.addTest(new AutoTest_GroupMul<N, T, U>(randomBase10(rd, N), randomBase10(rd, N)));
         ATB.addTest(new AutoTest_GroupDbl<N, T, U>(randomBase10(rd, N)));
         ATB.addTest(new AutoTest_GroupSpecialWellFormed<N, T, U>(randomBase10(rd, N)));
+        ATB.addTest(new AutoTest_GroupBatchAddSpecial<T>(rd() % 100));
+        ATB.addTest(new AutoTest_GroupGLV<T, typename T::ScalarField>);
     }
 }
 
@@ -228,9 +248,32 @@ void add_MultiExp(AutoTestBattery& ATB)
         ATB.addTest(new AutoTest_MultiExp_wnafExp<N, T, U>(
                         uniformBase10(0, 1000000),
                         randomBase10(rd, N)));
+
+        // full and random width scalars select the larger wNAF windows
+        ATB.addTest(new AutoTest_MultiExp_wnafExp<N, T, U>(
+                        N * GMP_NUMB_BITS,
+                        randomBase10(rd, N)));
+        ATB.addTest(new AutoTest_MultiExp_wnafExp<N, T, U>(
+                        1 + rd() % (N * GMP_NUMB_BITS),
+                        randomBase10(rd, N)));
+
         ATB.addTest(new AutoTest_MultiExp_multiExp<N, T, F, U, G>(rd() % 100));
         ATB.addTest(new AutoTest_MultiExp_multiExp01<N, T, F, U, G>(rd() % 100));
+        ATB.addTest(new AutoTest_MultiExp_bucketExp<T, F>(rd() % 1000, false));
+        ATB.addTest(new AutoTest_MultiExp_bucketExp<T, F>(rd() % 5000, true));
     }
+
+    // large enough for bucket method
+    ATB.addTest(new AutoTest_MultiExp_multiExp<N, T, F, U, G>(512 + rd() % 1000));
+    ATB.addTest(new AutoTest_MultiExp_multiExp01<N, T, F, U, G>(512 + rd() % 1000));
+    ATB.addTest(new AutoTest_MultiExp_multiThread<T, F>(512 + rd() % 1000, 2 + rd() % 8));
+    ATB.addTest(new AutoTest_MultiExp_scalarClass<T, F>(rd() % 5000));
+    ATB.addTest(new AutoTest_MultiExp_fixedBaseExp<T, F>(512 + rd() % 1000, 1 + rd() % 8));
+    ATB.addTest(new AutoTest_MultiExp_batchExp<T, F>(rd() % 1500, 1 + rd() % 8));
+
+    // more threads than windows, windows split into ranges of terms
+    ATB.addTest(new AutoTest_MultiExp_multiThread<T, F>(20000 + rd() % 20000, 32 + rd() % 32));
+    ATB.addTest(new AutoTest_MultiExp_fixedBaseExp<T, F>(20000 + rd() % 20000, 2 + rd() % 4, 32 + rd() % 32));
 }
 
 template <typename T, typename U>
@@ -246,6 +289,20 @@ void add_LagrangeFFT(AutoTestBattery& ATB)
         ATB.addTest(new AutoTest_LagrangeFFT_compute_Z<T, U>(2 + rd() % 100));
         ATB.addTest(new AutoTest_LagrangeFFT_add_poly_Z<T, U>(2 + rd() % 100));
         ATB.addTest(new AutoTest_LagrangeFFT_divide_by_Z_on_coset<T, U>(2 + rd() % 100));
+        ATB.addTest(new AutoTest_LagrangeFFT_sixStep<T>(2 + rd() % 5000));
+        ATB.addTest(new AutoTest_LagrangeFFT_cosetPowers<T>(2 + rd() % 5000));
+        ATB.addTest(new AutoTest_LagrangeFFT_batchFFT<T>(2 + rd() % 5000, rd() % 4));
+        ATB.addTest(new AutoTest_LagrangeFFT_domainCache<T>(2 + rd() % 5000, 1 + rd() % 8));
+        ATB.addTest(new AutoTest_LagrangeFFT_batchInvert<T>(rd() % 50000));
+
+        // radix-2 and step domains of several blocks
+        ATB.addTest(new AutoTest_LagrangeFFT_multiThread<T>(size_t(1) << (15 + rd() % 3), 2 + rd() % 8));
+        ATB.addTest(new AutoTest_LagrangeFFT_multiThread<T>((size_t(1) << 15) + 1 + rd() % 10000, 2 + rd() % 8));
+
+        // at least two blocks, no more blocks than block size
+        const size_t logn = 2 + rd() % 13;
+        ATB.addTest(new AutoTest_LagrangeFFT_hugeFFT<T>(size_t(1) << logn,
+                                                        size_t(1) << (1 + rd() % (logn / 2))));
     }
 }
 
@@ -272,6 +329,10 @@ void add_WindowExp(AutoTestBattery& ATB)
         ATB.addTest(new AutoTest_WindowExp_expPartition<T, F>(100, 3));
         ATB.addTest(new AutoTest_WindowExp_expPartition<T, F>(100, 4));
         ATB.addTest(new AutoTest_WindowExp_expPartition<T, F>(100, 5));
+        ATB.addTest(new AutoTest_WindowExp_multiThread<T, F>(1 + rd() % 100000, 2 + rd() % 8));
+        ATB.addTest(new AutoTest_WindowExp_batchExpThreads<T, F>(1 + rd() % 1000, 2 + rd() % 8));
+        ATB.addTest(new AutoTest_WindowExp_comb<T, F>(1 + rd() % 100000, 1 + rd() % (1u << 20)));
+        ATB.addTest(new AutoTest_WindowExp_cacheFile<T, F>(1 + rd() % 10000));
     }
 }
 
@@ -338,12 +399,24 @@ void add_QAP(AutoTestBattery& ATB)
                 for (const auto& cs : csvec) {
                     ATB.addTest(new AutoTest_QAP_ABCH_instance_map<SYS, T, U>(cs));
                     ATB.addTest(new AutoTest_QAP_Witness_map<SYS, T, U>(cs));
+                    ATB.addTest(new AutoTest_QAP_HugeWitness<SYS, T, U>(cs, 2, 2));
                 }
             }
         }
     }
 }
 
+template <typename T, typename U>
+void add_QAP_HugeWitness(AutoTestBattery& ATB)
+{
+    // basic radix-2 domain
+    ATB.addTest(new AutoTest_QAP_HugeWitness<R1System, T, U>(1000, 3, 8, 3));
+    ATB.addTest(new AutoTest_QAP_HugeWitness<R1System, T, U>(4000, 3, 16, 5));
+
+    // step domain is an error
+    ATB.addTest(new AutoTest_QAP_HugeWitness<R1System, T, U>(20000, 3, 16, 5));
+}
+
 template <template <typename> class SYS, typename PAIRING, typename T, typename U>
 void add_PPZK(AutoTestBattery& ATB)
 {
@@ -371,6 +444,24 @@ void add_PPZK(AutoTestBattery& ATB)
     }
 }
 
+template <typename PAIRING>
+void add_PPZK_prover(AutoTestBattery& ATB)
+{
+    // batch of witnesses with zero and one values, H in chunks
+    for (const size_t numSets : { 1, 2, 5 }) {
+        ATB.addTest(new AutoTest_PPZK_BatchProof<PAIRING>(10 + rd() % 100, numSets, 0));
+        ATB.addTest(new AutoTest_PPZK_BatchProof<PAIRING>(10 + rd() % 100, numSets, 2));
+    }
+
+    // precomputed proving key tables of several depths
+    for (const size_t depth : { 1, 2, 3, 5 }) {
+        ATB.addTest(new AutoTest_PPZK_PrecomputedKey<PAIRING>(10 + rd() % 100, depth));
+    }
+
+    // domain is made once for repeated proofs
+    ATB.addTest(new AutoTest_PPZK_DomainCache<PAIRING>(10 + rd() % 100));
+}
+
 template <typename GA, typename GB, mp_size_t N, typename F, typename PAIRING>
 void add_Marshalling(AutoTestBattery& ATB)
 {
@@ -503,6 +594,11 @@ int main(int argc, char *argv[])
     add_Field_Frobenius_map<Fqe, libsnark_Fqe>(ATB);
     add_Field_Frobenius_map<Fqk, libsnark_Fqk>(ATB);
     add_Field_cyclotomic_exp<NRQ, Fqk, libsnark_Fqk>(ATB);
+    add_Field_mulxADX<Fr>(ATB);
+    add_Field_mulxADX<Fq>(ATB);
+    add_Field_mul_array<Fr>(ATB);
+    add_Field_mul_array<Fq>(ATB);
+    add_Field_mul_array<Fqe>(ATB);
 
     // algebraic groups
     add_Group<NRQ, G1, libsnark_G1>(ATB);
@@ -529,10 +625,12 @@ int main(int argc, char *argv[])
     // quadratic arithmetic program
     add_QAP<R1System, Fr, libsnark_Fr>(ATB);
     add_QAP<HugeSystem, Fr, libsnark_Fr>(ATB);
+    add_QAP_HugeWitness<Fr, libsnark_Fr>(ATB);
 
     // pre-processed zero knowledge proof
     add_PPZK<R1System, PAIRING, Fr, libsnark_Fr>(ATB);
     add_PPZK<HugeSystem, PAIRING, Fr, libsnark_Fr>(ATB);
+    add_PPZK_prover<PAIRING>(ATB);
 
     // marshalling
     add_Marshalling<G1, G1, 1, Fr, PAIRING>(ATB);